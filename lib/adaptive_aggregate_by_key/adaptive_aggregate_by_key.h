@@ -0,0 +1,304 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "aggregate_by_key/aggregate_by_key.h"
+#include "flat_hash_map/flat_hash_map.h"
+#include "materialize/materialize.h"
+#include "size_hint/size_hint.h"
+
+enum class AggregationStrategy {
+  Auto,
+  // One FlatHashMap sized from the estimate, as AggregateByKey does.
+  Flat,
+  // Elements are scattered by key hash into partitions that are then
+  // aggregated one at a time, each with a table that fits the cache.
+  Partitioned,
+  // Elements are sorted by key and equal-key runs are folded.
+  Sort,
+};
+
+// What the sampling pass saw and what it decided, reported once the
+// aggregation is done.
+struct AggregationStats {
+  AggregationStrategy strategy = AggregationStrategy::Auto;
+  std::size_t sampled = 0;
+  std::size_t sample_distinct = 0;
+  double average_key_bytes = 0;
+  std::size_t estimated_groups = 0;
+  std::size_t estimated_table_bytes = 0;
+  // Upper bound on what Partitioned or Sort would buffer, zero when the
+  // input size is unknown.
+  std::size_t estimated_buffer_bytes = 0;
+  std::size_t partitions = 1;
+  std::size_t groups = 0;
+};
+
+// The first sample_size elements are buffered and their distinct keys
+// counted. The number of groups is extrapolated from how many sampled keys
+// occur only once (the GEE estimator), over the size hint of the input or,
+// without one, over unknown_size_factor times the sample. A table that
+// fits in cache_bytes is built flat; otherwise keys that are nearly all
+// distinct in the sample are sorted, and the rest use partitioned hashing.
+// Setting strategy skips the choice but still samples for the statistics.
+//
+// Partitioned and Sort hold a copy of every element, so they are only used
+// when the size hint or the end of the sample bounds the input and that
+// copy fits in max_buffered_bytes; otherwise the table is built flat.
+struct AggregationOptions {
+  AggregationStrategy strategy = AggregationStrategy::Auto;
+  std::size_t sample_size = 4096;
+  std::size_t cache_bytes = 1 << 20;
+  double sort_distinct_ratio = 0.9;
+  std::size_t unknown_size_factor = 16;
+  std::size_t max_buffered_bytes = 64 << 20;
+  std::function<void(const AggregationStats&)> on_stats;
+};
+
+// AggregateByKey that picks its strategy from a sample of the input. All
+// strategies return groups in the order their keys first appear, like
+// AggregateByKey. Elements must be copyable, and the sort strategy needs
+// keys with operator<; without it Partitioned is used instead.
+template <typename InitialValue, typename AggregateFunc,
+          typename KeyExtractorFunc>
+class AdaptiveAggregateByKeyRange {
+public:
+  static constexpr std::size_t kMaxPartitions = 1024;
+
+  AdaptiveAggregateByKeyRange(InitialValue initialValue,
+                              AggregateFunc aggregator,
+                              KeyExtractorFunc keyExtractor,
+                              AggregationOptions options)
+      : initialValue_(std::move(initialValue)),
+        aggregator_(std::move(aggregator)),
+        keyExtractor_(std::move(keyExtractor)), options_(std::move(options)) {}
+
+  template <typename Range>
+  auto operator|(Range&& range) const {
+    using Element = typename std::decay_t<Range>::value_type;
+    using Key = typename AggregateStoredKey<std::decay_t<
+        decltype(keyExtractor_(std::declval<const Element&>()))>>::type;
+    using AccumulatedValue = InitialValue;
+    using Result = std::vector<std::pair<Key, AccumulatedValue>>;
+
+    struct Group {
+      std::size_t first_seen;
+      AccumulatedValue value;
+    };
+    using Entry = std::pair<Key, Group>;
+
+    auto hint = GetSizeHint(range);
+    auto current = range.begin();
+    auto end = range.end();
+
+    std::vector<Element> sample;
+    FlatHashMap<Key, std::size_t> sample_counts;
+    std::size_t key_bytes = 0;
+    for (; sample.size() < options_.sample_size && current != end; ++current) {
+      sample.push_back(*current);
+      decltype(auto) key = keyExtractor_(sample.back());
+      auto [it, inserted] =
+          sample_counts.try_emplace(std::forward<decltype(key)>(key), 0);
+      if (inserted) {
+        key_bytes += EstimateMemoryUsage(it->first);
+      }
+      ++it->second;
+    }
+    AggregationStats stats = plan<Key, AccumulatedValue>(
+        sample_counts, sample.size(), key_bytes,
+        sizeof(std::pair<std::size_t, Element>), !(current != end), hint);
+
+    // Visits the sample and then the rest of the input, numbering elements
+    // in input order.
+    auto feed = [&](auto&& visit) {
+      std::size_t position = 0;
+      for (auto& element : sample) {
+        visit(std::move(element), position++);
+      }
+      for (; current != end; ++current) {
+        visit(*current, position++);
+      }
+    };
+
+    // Restores first-appearance order for the strategies that regroup.
+    auto inOrder = [](std::vector<Entry> entries) {
+      std::sort(entries.begin(), entries.end(),
+                [](const Entry& lhs, const Entry& rhs) {
+                  return lhs.second.first_seen < rhs.second.first_seen;
+                });
+      Result result;
+      result.reserve(entries.size());
+      for (auto& [key, group] : entries) {
+        result.emplace_back(std::move(key), std::move(group.value));
+      }
+      return result;
+    };
+
+    Result result;
+    if (stats.strategy == AggregationStrategy::Flat) {
+      FlatHashMap<Key, AccumulatedValue> table;
+      table.reserve(stats.estimated_groups);
+      feed([&](auto&& element, std::size_t) {
+        decltype(auto) key = keyExtractor_(element);
+        auto [it, inserted] = table.try_emplace(
+            std::forward<decltype(key)>(key), initialValue_);
+        aggregator_(element, it->second);
+      });
+      auto entries = table.release();
+      result = Result(std::make_move_iterator(entries.begin()),
+                      std::make_move_iterator(entries.end()));
+    } else if (stats.strategy == AggregationStrategy::Partitioned) {
+      std::vector<std::vector<std::pair<std::size_t, Element>>> partitions(
+          stats.partitions);
+      int shift = 64 - std::countr_zero(stats.partitions);
+      FlatHash<Key> hash;
+      feed([&](auto&& element, std::size_t position) {
+        std::uint64_t hashed = hash(keyExtractor_(element));
+        partitions[static_cast<std::size_t>(hashed >> shift)].emplace_back(
+            position, std::forward<decltype(element)>(element));
+      });
+
+      std::vector<Entry> groups;
+      for (auto& partition : partitions) {
+        FlatHashMap<Key, Group> table;
+        for (const auto& [position, element] : partition) {
+          decltype(auto) key = keyExtractor_(element);
+          auto [it, inserted] = table.try_emplace(
+              std::forward<decltype(key)>(key), position, initialValue_);
+          aggregator_(element, it->second.value);
+        }
+        partition = {};
+        for (auto& entry : table.release()) {
+          groups.push_back(std::move(entry));
+        }
+      }
+      result = inOrder(std::move(groups));
+    } else if constexpr (std::totally_ordered<Key>) {
+      std::vector<Element> elements;
+      std::vector<std::pair<Key, std::size_t>> order;
+      feed([&](auto&& element, std::size_t position) {
+        order.emplace_back(Key(keyExtractor_(element)), position);
+        elements.push_back(std::forward<decltype(element)>(element));
+      });
+      std::sort(order.begin(), order.end());
+
+      std::vector<Entry> groups;
+      for (auto& [key, position] : order) {
+        if (groups.empty() || groups.back().first != key) {
+          groups.emplace_back(std::move(key), Group{position, initialValue_});
+        }
+        aggregator_(elements[position], groups.back().second.value);
+      }
+      result = inOrder(std::move(groups));
+    }
+
+    stats.groups = result.size();
+    if (options_.on_stats) {
+      options_.on_stats(stats);
+    }
+    return result;
+  }
+
+private:
+  InitialValue initialValue_;
+  AggregateFunc aggregator_;
+  KeyExtractorFunc keyExtractor_;
+  AggregationOptions options_;
+
+  template <typename Key, typename AccumulatedValue>
+  AggregationStats plan(const FlatHashMap<Key, std::size_t>& sample_counts,
+                        std::size_t sampled, std::size_t key_bytes,
+                        std::size_t element_bytes, bool exhausted,
+                        std::optional<SizeHint> hint) const {
+    AggregationStats stats;
+    stats.sampled = sampled;
+    stats.sample_distinct = sample_counts.size();
+    if (stats.sample_distinct != 0) {
+      stats.average_key_bytes = static_cast<double>(key_bytes) /
+                                static_cast<double>(stats.sample_distinct);
+    }
+
+    if (exhausted || sampled == 0) {
+      stats.estimated_groups = stats.sample_distinct;
+    } else {
+      std::size_t singletons = 0;
+      for (const auto& [key, count] : sample_counts) {
+        singletons += count == 1;
+      }
+      double total = hint ? static_cast<double>(std::max(hint->value, sampled))
+                          : static_cast<double>(sampled) *
+                                static_cast<double>(options_.unknown_size_factor);
+      double scale = std::sqrt(total / static_cast<double>(sampled));
+      stats.estimated_groups = static_cast<std::size_t>(std::llround(
+          scale * static_cast<double>(singletons) +
+          static_cast<double>(stats.sample_distinct - singletons)));
+    }
+
+    double entry_bytes = stats.average_key_bytes + sizeof(AccumulatedValue) +
+                         3 * sizeof(std::size_t);
+    stats.estimated_table_bytes = static_cast<std::size_t>(
+        static_cast<double>(stats.estimated_groups) * entry_bytes);
+    std::size_t cache_bytes = std::max<std::size_t>(options_.cache_bytes, 1);
+    stats.partitions = std::clamp<std::size_t>(
+        std::bit_ceil((stats.estimated_table_bytes + cache_bytes - 1) / cache_bytes),
+        2, kMaxPartitions);
+
+    stats.strategy = options_.strategy;
+    if (stats.strategy == AggregationStrategy::Auto) {
+      if (stats.estimated_table_bytes <= cache_bytes) {
+        stats.strategy = AggregationStrategy::Flat;
+      } else if (static_cast<double>(stats.sample_distinct) >=
+                 options_.sort_distinct_ratio * static_cast<double>(sampled)) {
+        stats.strategy = AggregationStrategy::Sort;
+      } else {
+        stats.strategy = AggregationStrategy::Partitioned;
+      }
+    }
+    if (stats.strategy == AggregationStrategy::Sort &&
+        !std::totally_ordered<Key>) {
+      stats.strategy = AggregationStrategy::Partitioned;
+    }
+    if (exhausted || hint) {
+      std::size_t bound = exhausted ? sampled : std::max(hint->value, sampled);
+      stats.estimated_buffer_bytes = bound * element_bytes;
+    }
+    if (stats.strategy != AggregationStrategy::Flat &&
+        (stats.estimated_buffer_bytes == 0 ||
+         stats.estimated_buffer_bytes > options_.max_buffered_bytes)) {
+      stats.strategy = AggregationStrategy::Flat;
+    }
+    if (stats.strategy != AggregationStrategy::Partitioned) {
+      stats.partitions = 1;
+    }
+    return stats;
+  }
+};
+
+template <typename InitialValue, typename AggregateFunc,
+          typename KeyExtractorFunc>
+auto AggregateByKey(InitialValue initialValue, AggregateFunc aggregator,
+                    KeyExtractorFunc keyExtractor, AggregationOptions options) {
+  return AdaptiveAggregateByKeyRange<InitialValue, AggregateFunc,
+                                     KeyExtractorFunc>(
+      std::move(initialValue), std::move(aggregator), std::move(keyExtractor),
+      std::move(options));
+}
+
+template <typename Range, typename InitialValue, typename AggregateFunc,
+          typename KeyExtractorFunc>
+auto operator|(Range&& range,
+               const AdaptiveAggregateByKeyRange<InitialValue, AggregateFunc,
+                                                 KeyExtractorFunc>& operation) {
+  return operation.operator|(std::forward<Range>(range));
+}
@@ -1,64 +1,85 @@
 #pragma once
 
 #include <algorithm>
-#include <unordered_map>
+#include <iterator>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "flat_hash_map/flat_hash_map.h"
+
 
 template <typename Container> 
 auto AsDataFlow(Container &&container) {
   return std::forward<Container>(container);
 }
 
-template <typename Range> 
+template <typename Range>
+  requires requires(Range& range) { range.begin(); }
 auto AsVector(Range &&range) {
   using value_type = typename std::decay_t<Range>::value_type;
   return std::vector<value_type>(std::begin(range), std::end(range));
 }
 
+// Key type stored for a key extractor result. A string_view key is looked
+// up as is but stored as a std::string, because it usually points into the
+// element being aggregated.
+template <typename Key> 
+struct AggregateStoredKey {
+  using type = Key;
+};
+
+template <typename CharT, typename Traits>
+struct AggregateStoredKey<std::basic_string_view<CharT, Traits>> {
+  using type = std::basic_string<CharT, Traits>;
+};
+
 template <typename InitialValue, typename AggregateFunc,
           typename KeyExtractorFunc>
 class AggregateByKeyRange {
 public:
   AggregateByKeyRange(InitialValue initialValue, AggregateFunc aggregator,
-                      KeyExtractorFunc keyExtractor)
+                      KeyExtractorFunc keyExtractor,
+                      std::pmr::memory_resource* resource =
+                          std::pmr::get_default_resource())
       : initialValue_(std::move(initialValue)),
         aggregator_(std::move(aggregator)),
-        keyExtractor_(std::move(keyExtractor)) {}
+        keyExtractor_(std::move(keyExtractor)), resource_(resource) {}
 
   template <typename Range> 
   auto operator|(Range&& range) const {
     using Element = typename std::decay_t<Range>::value_type;
-    using Key = std::decay_t<decltype(keyExtractor_(std::declval<Element>()))>;
+    using Key = typename AggregateStoredKey<std::decay_t<
+        decltype(keyExtractor_(std::declval<const Element&>()))>>::type;
     using AccumulatedValue = InitialValue;
 
-    std::unordered_map<Key, AccumulatedValue> aggregated;
+    // The table is not presized from a size hint: that counts elements,
+    // and there are usually far fewer distinct keys.
+    FlatHashMap<Key, AccumulatedValue> aggregated(resource_);
 
+    // A key extractor returning a reference or a string_view is probed
+    // without a copy; the key is only copied when it is first inserted.
     for (const auto &element : range) {
-      Key key = keyExtractor_(element);
-
-      if (aggregated.find(key) == aggregated.end()) {
-        aggregated[key] = initialValue_;
-      }
-
-      aggregator_(element, aggregated[key]);
-    }
-
-    std::vector<std::pair<Key, AccumulatedValue>> result;
-    result.reserve(aggregated.size());
-
-    for (const auto &[key, value] : aggregated) {
-      result.emplace_back(key, value);
+      decltype(auto) key = keyExtractor_(element);
+      auto [it, inserted] = aggregated.try_emplace(
+          std::forward<decltype(key)>(key), initialValue_);
+      aggregator_(element, it->second);
     }
 
-    return result;
+    auto entries = aggregated.release();
+    return std::vector<std::pair<Key, AccumulatedValue>>(
+        std::make_move_iterator(entries.begin()),
+        std::make_move_iterator(entries.end()));
   }
 
 private:
   InitialValue initialValue_;
   AggregateFunc aggregator_;
   KeyExtractorFunc keyExtractor_;
+  std::pmr::memory_resource* resource_;
 };
 
 template <typename InitialValue, typename AggregateFunc,
@@ -69,6 +90,18 @@ auto AggregateByKey(InitialValue initialValue, AggregateFunc aggregator,
       std::move(initialValue), std::move(aggregator), std::move(keyExtractor));
 }
 
+// The aggregation table is allocated from the given resource; the
+// resulting vector still uses the global allocator.
+template <typename InitialValue, typename AggregateFunc,
+          typename KeyExtractorFunc>
+auto AggregateByKey(InitialValue initialValue, AggregateFunc aggregator,
+                    KeyExtractorFunc keyExtractor,
+                    std::pmr::memory_resource* resource) {
+  return AggregateByKeyRange<InitialValue, AggregateFunc, KeyExtractorFunc>(
+      std::move(initialValue), std::move(aggregator), std::move(keyExtractor),
+      resource);
+}
+
 template <typename Range, typename InitialValue, typename AggregateFunc,
           typename KeyExtractorFunc>
 auto operator|(Range&& range, const AggregateByKeyRange<InitialValue, AggregateFunc,
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "aggregate_by_key/aggregate_by_key.h"
+#include "size_hint/size_hint.h"
+
+// Lazy AggregateByKey for input where equal keys are adjacent. Each step
+// folds one run of equal keys and yields (key, accumulated), so only the
+// current group is held in memory. A key that reappears after a different
+// one starts a new group.
+template <typename Iterator, typename InitialValue, typename AggregateFunc,
+          typename KeyExtractorFunc>
+class AggregateConsecutiveIterator {
+public:
+  using key_type = typename AggregateStoredKey<std::decay_t<
+      decltype(std::declval<KeyExtractorFunc>()(*std::declval<Iterator>()))>>::type;
+
+  using iterator_category = std::input_iterator_tag;
+  using value_type = std::pair<key_type, InitialValue>;
+  using difference_type =
+      typename std::iterator_traits<Iterator>::difference_type;
+  using pointer = const value_type*;
+  using reference = const value_type&;
+
+  AggregateConsecutiveIterator(Iterator current, Iterator end,
+                               const InitialValue& initialValue,
+                               AggregateFunc aggregator,
+                               KeyExtractorFunc keyExtractor)
+      : current_(current), end_(end), initialValue_(&initialValue),
+        aggregator_(aggregator), keyExtractor_(keyExtractor) {
+    readGroup();
+  }
+
+  reference operator*() const { return *group_; }
+
+  pointer operator->() const { return &*group_; }
+
+  AggregateConsecutiveIterator& operator++() {
+    readGroup();
+    return *this;
+  }
+
+  bool operator!=(const AggregateConsecutiveIterator& other) const {
+    return group_.has_value() != other.group_.has_value() ||
+           current_ != other.current_;
+  }
+
+private:
+  Iterator current_;
+  Iterator end_;
+  const InitialValue* initialValue_;
+  AggregateFunc aggregator_;
+  KeyExtractorFunc keyExtractor_;
+  std::optional<value_type> group_;
+
+  void readGroup() {
+    if (!(current_ != end_)) {
+      group_.reset();
+      return;
+    }
+    group_.emplace(key_type(keyExtractor_(*current_)), *initialValue_);
+    do {
+      aggregator_(*current_, group_->second);
+      ++current_;
+    } while (current_ != end_ && keyExtractor_(*current_) == group_->first);
+  }
+};
+
+template <typename Range, typename InitialValue, typename AggregateFunc,
+          typename KeyExtractorFunc>
+class AggregateConsecutiveRange {
+public:
+  using iterator =
+      AggregateConsecutiveIterator<typename std::decay_t<Range>::iterator,
+                                   InitialValue, AggregateFunc,
+                                   KeyExtractorFunc>;
+  using const_iterator =
+      AggregateConsecutiveIterator<typename std::decay_t<Range>::const_iterator,
+                                   InitialValue, AggregateFunc,
+                                   KeyExtractorFunc>;
+  using value_type = typename iterator::value_type;
+
+  AggregateConsecutiveRange(Range&& range, InitialValue initialValue,
+                            AggregateFunc aggregator,
+                            KeyExtractorFunc keyExtractor)
+      : range_(std::forward<Range>(range)),
+        initialValue_(std::move(initialValue)),
+        aggregator_(std::move(aggregator)),
+        keyExtractor_(std::move(keyExtractor)) {}
+
+  iterator begin() {
+    return iterator(range_.begin(), range_.end(), initialValue_, aggregator_,
+                    keyExtractor_);
+  }
+
+  iterator end() {
+    return iterator(range_.end(), range_.end(), initialValue_, aggregator_,
+                    keyExtractor_);
+  }
+
+  const_iterator begin() const {
+    return const_iterator(range_.begin(), range_.end(), initialValue_,
+                          aggregator_, keyExtractor_);
+  }
+
+  const_iterator end() const {
+    return const_iterator(range_.end(), range_.end(), initialValue_,
+                          aggregator_, keyExtractor_);
+  }
+
+  std::optional<SizeHint> size_hint() const {
+    return AsUpperBound(GetSizeHint(range_));
+  }
+
+private:
+  Range range_;
+  InitialValue initialValue_;
+  AggregateFunc aggregator_;
+  KeyExtractorFunc keyExtractor_;
+};
+
+template <typename InitialValue, typename AggregateFunc,
+          typename KeyExtractorFunc>
+class AggregateConsecutiveOperation {
+public:
+  AggregateConsecutiveOperation(InitialValue initialValue,
+                                AggregateFunc aggregator,
+                                KeyExtractorFunc keyExtractor)
+      : initialValue_(std::move(initialValue)),
+        aggregator_(std::move(aggregator)),
+        keyExtractor_(std::move(keyExtractor)) {}
+
+  template <typename Range> 
+  auto operator|(Range&& range) const {
+    return AggregateConsecutiveRange<Range, InitialValue, AggregateFunc,
+                                     KeyExtractorFunc>(
+        std::forward<Range>(range), initialValue_, aggregator_, keyExtractor_);
+  }
+
+private:
+  InitialValue initialValue_;
+  AggregateFunc aggregator_;
+  KeyExtractorFunc keyExtractor_;
+};
+
+template <typename InitialValue, typename AggregateFunc,
+          typename KeyExtractorFunc>
+auto AggregateConsecutive(InitialValue initialValue, AggregateFunc aggregator,
+                          KeyExtractorFunc keyExtractor) {
+  return AggregateConsecutiveOperation<InitialValue, AggregateFunc,
+                                       KeyExtractorFunc>(
+      std::move(initialValue), std::move(aggregator), std::move(keyExtractor));
+}
+
+template <typename Range, typename InitialValue, typename AggregateFunc,
+          typename KeyExtractorFunc>
+auto operator|(Range&& range,
+               const AggregateConsecutiveOperation<InitialValue, AggregateFunc,
+                                                   KeyExtractorFunc>& op) {
+  return op.operator|(std::forward<Range>(range));
+}
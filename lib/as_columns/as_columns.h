@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "join/join.h"
+#include "size_hint/size_hint.h"
+
+template <typename... Fields> 
+class ColumnsIterator {
+public:
+  using iterator_category = std::input_iterator_tag;
+  using value_type = std::tuple<Fields...>;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+  using reference = std::tuple<const Fields&...>;
+
+  ColumnsIterator(const std::tuple<std::vector<Fields>...>* columns,
+                  std::size_t index)
+      : columns_(columns), index_(index) {}
+
+  reference operator*() const {
+    return std::apply(
+        [this](const auto&... column) { return reference(column[index_]...); },
+        *columns_);
+  }
+
+  ColumnsIterator& operator++() {
+    ++index_;
+    return *this;
+  }
+
+  bool operator==(const ColumnsIterator& other) const {
+    return index_ == other.index_;
+  }
+
+  bool operator!=(const ColumnsIterator& other) const {
+    return index_ != other.index_;
+  }
+
+private:
+  const std::tuple<std::vector<Fields>...>* columns_;
+  std::size_t index_;
+};
+
+// Struct-of-arrays storage: one contiguous vector per field. Iterating it
+// zips the columns back into tuples; column<I>() scans a single field.
+template <typename... Fields> 
+class Columns {
+public:
+  using value_type = std::tuple<Fields...>;
+  using iterator = ColumnsIterator<Fields...>;
+  using const_iterator = ColumnsIterator<Fields...>;
+
+  template <std::size_t I> 
+  const auto& column() const { return std::get<I>(columns_); }
+
+  template <std::size_t I> 
+  auto& column() { return std::get<I>(columns_); }
+
+  std::size_t size() const { return std::get<0>(columns_).size(); }
+
+  bool empty() const { return size() == 0; }
+
+  void reserve(std::size_t size) {
+    std::apply([size](auto&... column) { (column.reserve(size), ...); },
+               columns_);
+  }
+
+  template <typename... Args> 
+  void push_back(Args&&... fields) {
+    static_assert(sizeof...(Args) == sizeof...(Fields));
+    std::apply(
+        [&](auto&... column) {
+          (column.emplace_back(std::forward<Args>(fields)), ...);
+        },
+        columns_);
+  }
+
+  iterator begin() const { return iterator(&columns_, 0); }
+  iterator end() const { return iterator(&columns_, size()); }
+
+private:
+  std::tuple<std::vector<Fields>...> columns_;
+};
+
+template <typename T> 
+struct ColumnFields;
+
+template <typename First, typename Second>
+struct ColumnFields<std::pair<First, Second>> {
+  using columns_type = Columns<First, Second>;
+
+  static auto Get(const std::pair<First, Second>& item) {
+    return std::tie(item.first, item.second);
+  }
+};
+
+template <typename... Types> 
+struct ColumnFields<std::tuple<Types...>> {
+  using columns_type = Columns<Types...>;
+
+  static auto Get(const std::tuple<Types...>& item) {
+    return std::apply(
+        [](const auto&... fields) { return std::tie(fields...); }, item);
+  }
+};
+
+template <typename K, typename V> 
+struct ColumnFields<KV<K, V>> {
+  using columns_type = Columns<K, V>;
+
+  static auto Get(const KV<K, V>& item) {
+    return std::tie(item.key, item.value);
+  }
+};
+
+template <typename LeftType, typename RightType>
+struct ColumnFields<JoinResult<LeftType, RightType>> {
+  using columns_type = Columns<LeftType, std::optional<RightType>>;
+
+  static auto Get(const JoinResult<LeftType, RightType>& item) {
+    return std::tie(item.left, item.right);
+  }
+};
+
+template <typename... Projections> 
+class AsColumnsOperation {
+public:
+  explicit AsColumnsOperation(Projections... projections)
+      : projections_(std::move(projections)...) {}
+
+  template <typename Range> 
+  auto operator|(Range&& range) const {
+    using Element = typename std::decay_t<Range>::value_type;
+
+    if constexpr (sizeof...(Projections) == 0) {
+      return collect<typename ColumnFields<Element>::columns_type>(
+          range,
+          [](const Element& item) { return ColumnFields<Element>::Get(item); });
+    } else {
+      using columns_type = Columns<std::decay_t<
+          std::invoke_result_t<const Projections&, const Element&>>...>;
+      using fields_type = std::tuple<
+          std::invoke_result_t<const Projections&, const Element&>...>;
+      return collect<columns_type>(range, [this](const Element& item) {
+        return std::apply(
+            [&item](const auto&... projection) {
+              return fields_type(std::invoke(projection, item)...);
+            },
+            projections_);
+      });
+    }
+  }
+
+private:
+  std::tuple<Projections...> projections_;
+
+  template <typename ColumnsType, typename Range, typename Splitter>
+  static ColumnsType collect(Range& range, Splitter splitter) {
+    ColumnsType result;
+    if (auto hint = GetSizeHint(range); hint && hint->exact) {
+      result.reserve(hint->value);
+    }
+    for (const auto& item : range) {
+      std::apply([&result](const auto&... fields) { result.push_back(fields...); },
+                 splitter(item));
+    }
+    return result;
+  }
+};
+
+// Without arguments splits pairs, tuples, KV and JoinResult; a list of
+// member pointers (or other projections) selects the fields of a struct.
+template <typename... Projections> 
+auto AsColumns(Projections... projections) {
+  return AsColumnsOperation<Projections...>(std::move(projections)...);
+}
+
+template <typename Range, typename... Projections>
+auto operator|(Range&& range, const AsColumnsOperation<Projections...>& op) {
+  return op.operator|(std::forward<Range>(range));
+}
@@ -1,6 +1,9 @@
 #pragma once
 
-#include <type_traits> 
+#include <optional>
+#include <type_traits>
+
+#include "size_hint/size_hint.h"
 
 template <typename Container>
 class AsDataFlowRange {
@@ -11,18 +14,22 @@ public:
 
   AsDataFlowRange(Container& cont): 
   begin_it_(cont.begin()), end_it_(cont.end()), 
-  const_begin_it_(cont.begin()), const_end_it_(cont.end()) { }
+  const_begin_it_(cont.begin()), const_end_it_(cont.end()),
+  size_hint_(GetSizeHint(cont)) { }
 
   const_iterator begin() const { return const_begin_it_; }
   const_iterator end() const { return const_end_it_; }
   iterator begin() { return begin_it_; }
   iterator end() { return end_it_; }
 
+  std::optional<SizeHint> size_hint() const { return size_hint_; }
+
 private:
   iterator begin_it_;
   iterator end_it_;
   const_iterator const_begin_it_;
   const_iterator const_end_it_;
+  std::optional<SizeHint> size_hint_;
 };
 
 template <typename Container>
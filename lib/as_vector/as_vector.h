@@ -1,32 +1,62 @@
 #pragma once
 
+#include <iterator>
+#include <memory>
+#include <memory_resource>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "size_hint/size_hint.h"
 
-template <typename Range> 
-auto AsVectorImpl(Range&& range) {
-  using value_type = typename std::decay_t<Range>::iterator::value_type;
-  std::vector<value_type> result;
-  for (const auto& elem: range) {
-    result.push_back(elem);
+
+template <typename Range, typename Allocator = std::allocator<char>> 
+auto AsVectorImpl(Range&& range, const Allocator& allocator = Allocator()) {
+  using value_type = typename std::iterator_traits<
+      typename std::decay_t<Range>::iterator>::value_type;
+  using vector_allocator = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<value_type>;
+  using range_iterator = decltype(range.begin());
+  std::vector<value_type, vector_allocator> result(allocator);
+  if constexpr (std::is_base_of_v<std::forward_iterator_tag,
+                                  typename std::iterator_traits<
+                                      range_iterator>::iterator_category>) {
+    result.assign(range.begin(), range.end());
+  } else {
+    if (auto hint = GetSizeHint(range); hint && hint->exact) {
+      result.reserve(hint->value);
+    }
+    for (const auto& elem: range) {
+      result.push_back(elem);
+    }
   }
 
   return result;
 }
 
+template <typename Allocator = std::allocator<char>>
 class AsVectorOperation {
 public:
+  explicit AsVectorOperation(const Allocator& allocator = Allocator())
+      : allocator_(allocator) {}
+
   template <typename Range> 
   auto operator|(Range&& range) const {
-    return AsVectorImpl(std::forward<Range>(range));
+    return AsVectorImpl(std::forward<Range>(range), allocator_);
   }
+
+private:
+  Allocator allocator_;
 };
 
-inline auto AsVector() { return AsVectorOperation(); }
+inline auto AsVector() { return AsVectorOperation<>(); }
+
+// Collects into a std::pmr::vector backed by the given resource.
+inline auto AsVector(std::pmr::memory_resource* resource) {
+  return AsVectorOperation<std::pmr::polymorphic_allocator<char>>(resource);
+}
 
-template <typename Range>
-auto operator|(Range &&range, const AsVectorOperation& op) {
+template <typename Range, typename Allocator>
+auto operator|(Range &&range, const AsVectorOperation<Allocator>& op) {
   return op.operator|(std::forward<Range>(range));
 }
\ No newline at end of file
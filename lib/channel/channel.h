@@ -0,0 +1,363 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+// Bounded lock-free ring buffer (sequence-numbered slots), safe for any
+// number of producers and consumers. Blocking operations spin, then yield,
+// then park on an atomic counter until the other side makes progress.
+template <typename T> 
+class Channel {
+public:
+  explicit Channel(std::size_t capacity = 1024)
+      : capacity_(roundUpToPowerOfTwo(capacity)), mask_(capacity_ - 1),
+        slots_(std::make_unique<Slot[]>(capacity_)) {
+    for (std::size_t i = 0; i < capacity_; ++i) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  Channel(const Channel&) = delete;
+  Channel& operator=(const Channel&) = delete;
+
+  ~Channel() {
+    std::size_t head = head_.load(std::memory_order_relaxed);
+    for (std::size_t i = tail_.load(std::memory_order_relaxed); i != head; ++i) {
+      std::launder(reinterpret_cast<T*>(slots_[i & mask_].storage))->~T();
+    }
+  }
+
+  // Returns false without blocking when the channel is full or closed. An
+  // rvalue is moved from only when it is accepted.
+  bool TryPush(const T& value) {
+    T copy(value);
+    return TryPush(std::move(copy));
+  }
+
+  bool TryPush(T&& value) { return !closed_.load() && tryPush(value); }
+
+  bool TryPop(T& value) {
+    return tryPop([&](T&& stored) { value = std::move(stored); });
+  }
+
+  // Moves the element straight into `value`, so T needs neither a default
+  // constructor nor assignment.
+  bool TryPop(std::optional<T>& value) {
+    return tryPop([&](T&& stored) { value.emplace(std::move(stored)); });
+  }
+
+  // Blocks while the channel is full. Returns false if it has been closed.
+  bool Push(T value) {
+    return waitFor(popped_, push_waiters_, [&] {
+      if (closed_.load()) {
+        return std::optional<bool>(false);
+      }
+      return tryPush(value) ? std::optional<bool>(true) : std::nullopt;
+    });
+  }
+
+  // Blocks while the channel is empty. Returns false once it is closed and
+  // drained.
+  bool Pop(T& value) { return pop(value); }
+
+  bool Pop(std::optional<T>& value) { return pop(value); }
+
+  void Close() {
+    closed_.store(true);
+    pushed_.fetch_add(1);
+    popped_.fetch_add(1);
+    pushed_.notify_all();
+    popped_.notify_all();
+  }
+
+  bool closed() const { return closed_.load(); }
+
+  std::size_t capacity() const { return capacity_; }
+
+private:
+  struct Slot {
+    std::atomic<std::size_t> sequence;
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+
+  static constexpr int kSpinIterations = 64;
+  static constexpr int kYieldIterations = 16;
+  static constexpr std::size_t kCacheLine = 64;
+
+  std::size_t capacity_;
+  std::size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+  alignas(kCacheLine) std::atomic<std::size_t> head_{0};
+  alignas(kCacheLine) std::atomic<std::size_t> tail_{0};
+  alignas(kCacheLine) std::atomic<std::uint32_t> pushed_{0};
+  std::atomic<std::uint32_t> pop_waiters_{0};
+  alignas(kCacheLine) std::atomic<std::uint32_t> popped_{0};
+  std::atomic<std::uint32_t> push_waiters_{0};
+  std::atomic<bool> closed_{false};
+
+  static std::size_t roundUpToPowerOfTwo(std::size_t value) {
+    std::size_t result = 2;
+    while (result < value) {
+      result <<= 1;
+    }
+    return result;
+  }
+
+  bool tryPush(T& value) {
+    std::size_t position = head_.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+      slot = &slots_[position & mask_];
+      std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::ptrdiff_t>(sequence) -
+                  static_cast<std::ptrdiff_t>(position);
+      if (diff == 0) {
+        if (head_.compare_exchange_weak(position, position + 1,
+                                        std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        position = head_.load(std::memory_order_relaxed);
+      }
+    }
+
+    new (slot->storage) T(std::move(value));
+    slot->sequence.store(position + 1, std::memory_order_release);
+    signal(pushed_, pop_waiters_);
+    return true;
+  }
+
+  template <typename Store>
+  bool tryPop(Store store) {
+    std::size_t position = tail_.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+      slot = &slots_[position & mask_];
+      std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::ptrdiff_t>(sequence) -
+                  static_cast<std::ptrdiff_t>(position + 1);
+      if (diff == 0) {
+        if (tail_.compare_exchange_weak(position, position + 1,
+                                        std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        position = tail_.load(std::memory_order_relaxed);
+      }
+    }
+
+    T* stored = std::launder(reinterpret_cast<T*>(slot->storage));
+    store(std::move(*stored));
+    stored->~T();
+    slot->sequence.store(position + capacity_, std::memory_order_release);
+    signal(popped_, push_waiters_);
+    return true;
+  }
+
+  template <typename Value>
+  bool pop(Value& value) {
+    return waitFor(pushed_, pop_waiters_, [&] {
+      if (TryPop(value)) {
+        return std::optional<bool>(true);
+      }
+      if (closed_.load()) {
+        return std::optional<bool>(TryPop(value));
+      }
+      return std::optional<bool>();
+    });
+  }
+
+  static void signal(std::atomic<std::uint32_t>& counter,
+                     std::atomic<std::uint32_t>& waiters) {
+    counter.fetch_add(1);
+    if (waiters.load() != 0) {
+      counter.notify_all();
+    }
+  }
+
+  // Retries attempt() until it yields a result: a short busy spin, then
+  // yielding the time slice, then sleeping on the progress counter.
+  template <typename Attempt>
+  static bool waitFor(std::atomic<std::uint32_t>& counter,
+                      std::atomic<std::uint32_t>& waiters, Attempt attempt) {
+    for (int i = 0; i < kSpinIterations; ++i) {
+      if (auto result = attempt()) {
+        return *result;
+      }
+    }
+    for (int i = 0; i < kYieldIterations; ++i) {
+      std::this_thread::yield();
+      if (auto result = attempt()) {
+        return *result;
+      }
+    }
+    while (true) {
+      std::uint32_t observed = counter.load();
+      if (auto result = attempt()) {
+        return *result;
+      }
+      waiters.fetch_add(1);
+      counter.wait(observed);
+      waiters.fetch_sub(1);
+    }
+  }
+};
+
+template <typename T> 
+class ChannelIterator {
+public:
+  using iterator_category = std::input_iterator_tag;
+  using value_type = T;
+  using difference_type = std::ptrdiff_t;
+  using pointer = value_type*;
+  using reference = value_type&;
+
+  explicit ChannelIterator(Channel<T>* channel = nullptr) : channel_(channel) {
+    if (channel_ != nullptr) {
+      receive();
+    }
+  }
+
+  reference operator*() const { return *current_; }
+
+  pointer operator->() const { return &*current_; }
+
+  ChannelIterator& operator++() {
+    receive();
+    return *this;
+  }
+
+  bool operator!=(const ChannelIterator& other) const {
+    return current_.has_value() != other.current_.has_value();
+  }
+
+private:
+  Channel<T>* channel_;
+  mutable std::optional<T> current_;
+
+  // Pops straight into current_, which stays empty at the end of input.
+  void receive() {
+    current_.reset();
+    channel_->Pop(current_);
+  }
+};
+
+template <typename T> 
+class ChannelRange {
+public:
+  using value_type = T;
+  using iterator = ChannelIterator<T>;
+  using const_iterator = ChannelIterator<T>;
+
+  explicit ChannelRange(Channel<T>& channel) : channel_(&channel) {}
+
+  iterator begin() const { return iterator(channel_); }
+
+  iterator end() const { return iterator(); }
+
+private:
+  Channel<T>* channel_;
+};
+
+// Single-pass source: ends when the channel is closed and drained.
+template <typename T> 
+auto FromChannel(Channel<T>& channel) {
+  return ChannelRange<T>(channel);
+}
+
+template <typename T> 
+class ToChannelOperation {
+public:
+  ToChannelOperation(Channel<T>& channel, bool close_when_done)
+      : channel_(channel), close_when_done_(close_when_done) {}
+
+  template <typename Range> 
+  std::size_t operator|(Range&& range) const {
+    std::size_t pushed = 0;
+    for (const auto& item : range) {
+      if (!channel_.Push(item)) {
+        break;
+      }
+      ++pushed;
+    }
+    if (close_when_done_) {
+      channel_.Close();
+    }
+    return pushed;
+  }
+
+private:
+  Channel<T>& channel_;
+  bool close_when_done_;
+};
+
+// Pushes every element with backpressure and returns how many were
+// accepted. Closes the channel at the end unless told otherwise.
+template <typename T> 
+auto ToChannel(Channel<T>& channel, bool close_when_done = true) {
+  return ToChannelOperation<T>(channel, close_when_done);
+}
+
+template <typename Range, typename T>
+auto operator|(Range&& range, const ToChannelOperation<T>& op) {
+  return op.operator|(std::forward<Range>(range));
+}
+
+// Runs `FromChannel(channel()) | sink` on its own thread. The producer pushes
+// into channel() and calls Finish() to close it and collect the result.
+template <typename T, typename Sink> 
+class ChannelSinkThread {
+public:
+  using result_type =
+      decltype(std::declval<ChannelRange<T>>() | std::declval<const Sink&>());
+
+  ChannelSinkThread(const Sink& sink, std::size_t capacity)
+      : channel_(capacity), thread_([this, &sink] {
+          try {
+            result_.emplace(FromChannel(channel_) | sink);
+          } catch (...) {
+            exception_ = std::current_exception();
+            channel_.Close();
+          }
+        }) {}
+
+  ChannelSinkThread(const ChannelSinkThread&) = delete;
+  ChannelSinkThread& operator=(const ChannelSinkThread&) = delete;
+
+  ~ChannelSinkThread() {
+    if (thread_.joinable()) {
+      channel_.Close();
+      thread_.join();
+    }
+  }
+
+  Channel<T>& channel() { return channel_; }
+
+  result_type Finish() {
+    channel_.Close();
+    thread_.join();
+    if (exception_) {
+      std::rethrow_exception(exception_);
+    }
+    return std::move(*result_);
+  }
+
+private:
+  Channel<T> channel_;
+  std::optional<result_type> result_;
+  std::exception_ptr exception_;
+  std::thread thread_;
+};
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "aggregate_by_key/aggregate_by_key.h"
+#include "flat_hash_map/flat_hash_map.h"
+
+// HyperLogLog distinct counter over 64-bit hashes with 2^precision one-byte
+// registers, so the standard error is about 1.04 / sqrt(2^precision).
+// Until more than exact_threshold distinct hashes have been seen it keeps
+// the hashes themselves in a sorted vector and counts them exactly; past
+// that it switches to the registers. Small dense estimates use linear
+// counting over empty registers. The default threshold keeps the exact
+// set no larger than the registers would be. Sketches of equal precision merge into the
+// sketch of the combined input.
+class HyperLogLog {
+public:
+  static constexpr int kMinPrecision = 4;
+  static constexpr int kMaxPrecision = 18;
+
+  explicit HyperLogLog(int precision)
+      : HyperLogLog(precision, DefaultExactThreshold(precision)) {}
+
+  HyperLogLog(int precision, std::size_t exact_threshold)
+      : precision_(checkPrecision(precision)), exact_threshold_(exact_threshold) {
+    if (exact_threshold_ == 0) {
+      registers_.assign(std::size_t{1} << precision_, 0);
+    }
+  }
+
+  static std::size_t DefaultExactThreshold(int precision) {
+    return (std::size_t{1} << checkPrecision(precision)) / sizeof(std::uint64_t);
+  }
+
+  void Add(std::uint64_t hash) {
+    if (IsExact()) {
+      auto it = std::lower_bound(hashes_.begin(), hashes_.end(), hash);
+      if (it == hashes_.end() || *it != hash) {
+        hashes_.insert(it, hash);
+        if (hashes_.size() > exact_threshold_) {
+          toRegisters();
+        }
+      }
+      return;
+    }
+    addToRegisters(hash);
+  }
+
+  void Merge(const HyperLogLog& other) {
+    if (precision_ != other.precision_) {
+      throw std::invalid_argument("HyperLogLog: merging sketches of different precision");
+    }
+    if (other.IsExact()) {
+      for (std::uint64_t hash : other.hashes_) {
+        Add(hash);
+      }
+      return;
+    }
+    if (IsExact()) {
+      toRegisters();
+    }
+    for (std::size_t i = 0; i < registers_.size(); ++i) {
+      registers_[i] = std::max(registers_[i], other.registers_[i]);
+    }
+  }
+
+  std::size_t Estimate() const {
+    if (IsExact()) {
+      return hashes_.size();
+    }
+    double m = static_cast<double>(registers_.size());
+    double sum = 0;
+    std::size_t zeros = 0;
+    for (std::uint8_t value : registers_) {
+      sum += std::ldexp(1.0, -value);
+      zeros += value == 0;
+    }
+    double estimate = alpha() * m * m / sum;
+    if (estimate <= 2.5 * m && zeros != 0) {
+      estimate = m * std::log(m / static_cast<double>(zeros));
+    }
+    return static_cast<std::size_t>(std::llround(estimate));
+  }
+
+  bool IsExact() const { return registers_.empty(); }
+
+  int Precision() const { return precision_; }
+
+private:
+  int precision_;
+  std::size_t exact_threshold_;
+  std::vector<std::uint64_t> hashes_;
+  std::vector<std::uint8_t> registers_;
+
+  static int checkPrecision(int precision) {
+    if (precision < kMinPrecision || precision > kMaxPrecision) {
+      throw std::invalid_argument("HyperLogLog: precision must be in [4, 18]");
+    }
+    return precision;
+  }
+
+  double alpha() const {
+    switch (precision_) {
+    case 4:
+      return 0.673;
+    case 5:
+      return 0.697;
+    case 6:
+      return 0.709;
+    default:
+      return 0.7213 / (1.0 + 1.079 / static_cast<double>(registers_.size()));
+    }
+  }
+
+  void addToRegisters(std::uint64_t hash) {
+    std::size_t index = static_cast<std::size_t>(hash >> (64 - precision_));
+    // Rank of the first set bit in the remaining bits; the sentinel bit
+    // caps it at 64 - precision + 1 when they are all zero.
+    std::uint64_t rest = (hash << precision_) | (std::uint64_t{1} << (precision_ - 1));
+    auto rank = static_cast<std::uint8_t>(std::countl_zero(rest) + 1);
+    registers_[index] = std::max(registers_[index], rank);
+  }
+
+  void toRegisters() {
+    registers_.assign(std::size_t{1} << precision_, 0);
+    for (std::uint64_t hash : hashes_) {
+      addToRegisters(hash);
+    }
+    hashes_.clear();
+    hashes_.shrink_to_fit();
+  }
+};
+
+template <typename KeyExtractorFunc>
+class CountDistinctApproxOperation {
+public:
+  CountDistinctApproxOperation(int precision, KeyExtractorFunc keyExtractor,
+                               std::size_t exact_threshold)
+      : precision_(precision), keyExtractor_(std::move(keyExtractor)),
+        exact_threshold_(exact_threshold) {}
+
+  template <typename Range>
+  auto operator|(Range&& range) const {
+    using Element = typename std::decay_t<Range>::value_type;
+    using Key = typename AggregateStoredKey<std::decay_t<
+        decltype(keyExtractor_(std::declval<const Element&>()))>>::type;
+
+    FlatHash<Key> hash;
+    HyperLogLog sketch(precision_, exact_threshold_);
+    for (const auto& element : range) {
+      sketch.Add(hash(keyExtractor_(element)));
+    }
+    return sketch;
+  }
+
+private:
+  int precision_;
+  KeyExtractorFunc keyExtractor_;
+  std::size_t exact_threshold_;
+};
+
+// Counts the distinct keys of a range into a HyperLogLog sketch; call
+// Estimate() on the result. Keys are hashed as they come and never stored.
+template <typename KeyExtractorFunc>
+auto CountDistinctApprox(int precision, KeyExtractorFunc keyExtractor) {
+  return CountDistinctApproxOperation<KeyExtractorFunc>(
+      precision, std::move(keyExtractor),
+      HyperLogLog::DefaultExactThreshold(precision));
+}
+
+// exact_threshold bounds the distinct count kept exactly before the sketch
+// switches to registers; 0 makes it approximate from the start.
+template <typename KeyExtractorFunc>
+auto CountDistinctApprox(int precision, KeyExtractorFunc keyExtractor,
+                         std::size_t exact_threshold) {
+  return CountDistinctApproxOperation<KeyExtractorFunc>(
+      precision, std::move(keyExtractor), exact_threshold);
+}
+
+template <typename Range, typename KeyExtractorFunc>
+auto operator|(Range&& range,
+               const CountDistinctApproxOperation<KeyExtractorFunc>& operation) {
+  return operation.operator|(std::forward<Range>(range));
+}
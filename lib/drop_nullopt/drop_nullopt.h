@@ -1,9 +1,12 @@
 #pragma once
 
 #include <iterator>
+#include <optional>
 #include <type_traits>
 #include <utility>
 
+#include "size_hint/size_hint.h"
+
 template <typename Iterator> 
 class DropNulloptIterator {
 public:
@@ -63,6 +66,10 @@ public:
 
   auto end() const { return const_iterator(range_.end(), range_.end()); }
 
+  std::optional<SizeHint> size_hint() const {
+    return AsUpperBound(GetSizeHint(range_));
+  }
+
 private:
   Range range_;
 };
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "aggregate_by_key/aggregate_by_key.h"
+#include "flat_hash_map/flat_hash_map.h"
+#include "from_generator/from_generator.h"
+#include "materialize/materialize.h"
+
+// AggregateByKey that keeps its table under a memory budget. Whenever the
+// estimated table size passes the budget, the table is sorted by key and
+// written out as a run. At the end the runs are merged, at most
+// kMaterializeMergeFanIn at a time, and partial accumulators of equal keys
+// are folded with combiner(accumulated, other). The groups are the same as
+// AggregateByKey's but come out sorted by key.
+//
+// A group is charged when its key is first inserted: its key and initial
+// accumulator, the table's hash and slot words, and one more entry of
+// slack for the table doubling its storage. Growth of an accumulator after
+// insertion is not tracked, so accumulators that grow (strings, vectors)
+// can take the table past the budget. Spilled keys and accumulators must
+// be types Materialize supports.
+template <typename Range, typename InitialValue, typename AggregateFunc,
+          typename KeyExtractorFunc, typename CombineFunc, typename Key>
+Generator<std::pair<Key, InitialValue>>
+ExternalAggregateByKey(Range range, InitialValue initialValue,
+                       AggregateFunc aggregator, KeyExtractorFunc keyExtractor,
+                       CombineFunc combiner, MemoryBudget budget) {
+  using Entry = std::pair<Key, InitialValue>;
+  auto byKey = [](const Entry& lhs, const Entry& rhs) {
+    return lhs.first < rhs.first;
+  };
+
+  FlatHashMap<Key, InitialValue> table;
+  std::size_t used = 0;
+  std::optional<SpillDirectory> spill;
+  std::vector<MaterializedRange<Entry>> runs;
+
+  auto sortedEntries = [&] {
+    auto entries = table.release();
+    std::sort(entries.begin(), entries.end(), byKey);
+    used = 0;
+    return entries;
+  };
+
+  for (const auto& element : range) {
+    decltype(auto) key = keyExtractor(element);
+    auto [it, inserted] =
+        table.try_emplace(std::forward<decltype(key)>(key), initialValue);
+    if (inserted) {
+      used += EstimateMemoryUsage(it->first) +
+              EstimateMemoryUsage(it->second) + sizeof(Entry) +
+              3 * sizeof(std::size_t);
+    }
+    aggregator(element, it->second);
+
+    if (used > budget.bytes) {
+      if (!spill) {
+        spill.emplace(budget.spill_directory);
+      }
+      MaterializeWriter<Entry> writer(spill->File("run", runs.size()));
+      for (const auto& entry : sortedEntries()) {
+        writer.Write(entry);
+      }
+      runs.push_back(writer.Finish());
+    }
+  }
+
+  if (runs.empty()) {
+    for (auto& entry : sortedEntries()) {
+      co_yield entry;
+    }
+    co_return;
+  }
+
+  MaterializeWriter<Entry> writer(spill->File("run", runs.size()));
+  for (const auto& entry : sortedEntries()) {
+    writer.Write(entry);
+  }
+  runs.push_back(writer.Finish());
+
+  runs = ReduceRuns(std::move(runs), byKey, *spill, "merge");
+  MaterializedMerge<Entry, decltype(byKey)> merge(runs, byKey);
+  while (!merge.empty()) {
+    Entry group = std::move(merge.top());
+    merge.pop();
+    while (!merge.empty() && !(group.first < merge.top().first)) {
+      combiner(group.second, std::move(merge.top().second));
+      merge.pop();
+    }
+    co_yield group;
+  }
+}
+
+template <typename InitialValue, typename AggregateFunc,
+          typename KeyExtractorFunc, typename CombineFunc>
+class ExternalAggregateByKeyRange {
+public:
+  ExternalAggregateByKeyRange(InitialValue initialValue,
+                              AggregateFunc aggregator,
+                              KeyExtractorFunc keyExtractor,
+                              CombineFunc combiner, MemoryBudget budget)
+      : initialValue_(std::move(initialValue)),
+        aggregator_(std::move(aggregator)),
+        keyExtractor_(std::move(keyExtractor)), combiner_(std::move(combiner)),
+        budget_(std::move(budget)) {}
+
+  template <typename Range>
+  auto operator|(Range&& range) const {
+    using Element = typename std::decay_t<Range>::value_type;
+    using Key = typename AggregateStoredKey<std::decay_t<
+        decltype(keyExtractor_(std::declval<const Element&>()))>>::type;
+
+    return ExternalAggregateByKey<std::decay_t<Range>, InitialValue,
+                                  AggregateFunc, KeyExtractorFunc, CombineFunc,
+                                  Key>(std::forward<Range>(range),
+                                       initialValue_, aggregator_,
+                                       keyExtractor_, combiner_, budget_);
+  }
+
+private:
+  InitialValue initialValue_;
+  AggregateFunc aggregator_;
+  KeyExtractorFunc keyExtractor_;
+  CombineFunc combiner_;
+  MemoryBudget budget_;
+};
+
+template <typename InitialValue, typename AggregateFunc,
+          typename KeyExtractorFunc, typename CombineFunc>
+auto AggregateByKey(InitialValue initialValue, AggregateFunc aggregator,
+                    KeyExtractorFunc keyExtractor, CombineFunc combiner,
+                    MemoryBudget budget) {
+  return ExternalAggregateByKeyRange<InitialValue, AggregateFunc,
+                                     KeyExtractorFunc, CombineFunc>(
+      std::move(initialValue), std::move(aggregator), std::move(keyExtractor),
+      std::move(combiner), std::move(budget));
+}
+
+template <typename Range, typename InitialValue, typename AggregateFunc,
+          typename KeyExtractorFunc, typename CombineFunc>
+auto operator|(Range&& range,
+               const ExternalAggregateByKeyRange<InitialValue, AggregateFunc,
+                                                 KeyExtractorFunc, CombineFunc>&
+                   operation) {
+  return operation.operator|(std::forward<Range>(range));
+}
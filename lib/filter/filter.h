@@ -1,8 +1,11 @@
 #pragma once
 
 #include <iterator>
+#include <optional>
 #include <type_traits>
 
+#include "size_hint/size_hint.h"
+
 template <typename Iterator, typename Predicate> 
 class FilterIterator {
 public:
@@ -67,6 +70,10 @@ public:
     return const_iterator(range_.end(), range_.end(), predicate_);
   }
 
+  std::optional<SizeHint> size_hint() const {
+    return AsUpperBound(GetSizeHint(range_));
+  }
+
 private:
   Range range_;
   Predicate predicate_;
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "size_hint/size_hint.h"
+
+// Equivalent to Transform(func) | DropNullopt(), but func is called exactly
+// once per input element and the engaged value is kept in the iterator.
+template <typename Iterator, typename Function> 
+class FilterMapIterator {
+public:
+  using iterator_category = std::input_iterator_tag;
+  using value_type = typename std::decay_t<decltype(std::declval<Function>()(
+      *std::declval<Iterator>()))>::value_type;
+  using difference_type =
+      typename std::iterator_traits<Iterator>::difference_type;
+  using pointer = value_type*;
+  using reference = value_type&;
+
+  FilterMapIterator(Iterator current, Iterator end, Function func)
+      : current_(current), end_(end), func_(func) {
+    findNext();
+  }
+
+  reference operator*() const { return *value_; }
+
+  pointer operator->() const { return &*value_; }
+
+  FilterMapIterator &operator++() {
+    ++current_;
+    findNext();
+    return *this;
+  }
+
+  bool operator!=(const FilterMapIterator& other) const {
+    return current_ != other.current_;
+  }
+
+private:
+  Iterator current_;
+  Iterator end_;
+  Function func_;
+  mutable std::optional<value_type> value_;
+
+  void findNext() {
+    while (current_ != end_) {
+      value_ = func_(*current_);
+      if (value_.has_value()) {
+        return;
+      }
+      ++current_;
+    }
+  }
+};
+
+template <typename Range, typename Function> 
+class FilterMapRange {
+public:
+  using iterator =
+      FilterMapIterator<typename std::decay_t<Range>::iterator, Function>;
+  using const_iterator =
+      FilterMapIterator<typename std::decay_t<Range>::const_iterator, Function>;
+  using value_type = typename iterator::value_type;
+
+  FilterMapRange(Range&& range, Function func)
+      : range_(std::forward<Range>(range)), func_(std::move(func)) {}
+
+  iterator begin() { return iterator(range_.begin(), range_.end(), func_); }
+
+  iterator end() { return iterator(range_.end(), range_.end(), func_); }
+
+  const_iterator begin() const {
+    return const_iterator(range_.begin(), range_.end(), func_);
+  }
+
+  const_iterator end() const {
+    return const_iterator(range_.end(), range_.end(), func_);
+  }
+
+  std::optional<SizeHint> size_hint() const {
+    return AsUpperBound(GetSizeHint(range_));
+  }
+
+private:
+  Range range_;
+  Function func_;
+};
+
+template <typename Function> 
+class FilterMapOperation {
+public:
+  explicit FilterMapOperation(Function func) : func_(std::move(func)) {}
+
+  template <typename Range> 
+  auto operator|(Range&& range) const {
+    return FilterMapRange<Range, Function>(std::forward<Range>(range), func_);
+  }
+
+private:
+  Function func_;
+};
+
+template <typename Function> 
+auto FilterMap(Function func) {
+  return FilterMapOperation<Function>(std::move(func));
+}
+
+template <typename Range, typename Function>
+auto operator|(Range&& range, const FilterMapOperation<Function>& op) {
+  return op.operator|(std::forward<Range>(range));
+}
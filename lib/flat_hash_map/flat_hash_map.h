@@ -0,0 +1,268 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+inline constexpr std::uint64_t kFlatHashSecret[4] = {
+    0xA0761D6478BD642Full, 0xE7037ED1A0B428DBull, 0x8EBC6AF09C88C6E3ull,
+    0x589965CC75374CC3ull};
+
+// Full 64x64 -> 128 bit product, low half in a and high half in b.
+inline void FlatHashMultiply(std::uint64_t& a, std::uint64_t& b) {
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+  a = static_cast<std::uint64_t>(product);
+  b = static_cast<std::uint64_t>(product >> 64);
+#else
+  std::uint64_t a_high = a >> 32, a_low = static_cast<std::uint32_t>(a);
+  std::uint64_t b_high = b >> 32, b_low = static_cast<std::uint32_t>(b);
+  std::uint64_t high = a_high * b_high, middle0 = a_high * b_low;
+  std::uint64_t middle1 = a_low * b_high, low = a_low * b_low;
+  std::uint64_t t = low + (middle0 << 32);
+  std::uint64_t carry = t < low;
+  std::uint64_t lower = t + (middle1 << 32);
+  carry += lower < t;
+  high += (middle0 >> 32) + (middle1 >> 32) + carry;
+  a = lower;
+  b = high;
+#endif
+}
+
+inline std::uint64_t FlatHashMix(std::uint64_t a, std::uint64_t b) {
+  FlatHashMultiply(a, b);
+  return a ^ b;
+}
+
+inline std::uint64_t FlatHashRead8(const char* data) {
+  std::uint64_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+inline std::uint64_t FlatHashRead4(const char* data) {
+  std::uint32_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+// wyhash-style byte hash: reads 16 bytes per round with one wide multiply.
+inline std::uint64_t FlatHashBytes(const void* key, std::size_t length,
+                                   std::uint64_t seed = 0) {
+  const auto* secret = kFlatHashSecret;
+  auto data = static_cast<const char*>(key);
+  seed ^= FlatHashMix(seed ^ secret[0], secret[1]);
+  std::uint64_t a = 0;
+  std::uint64_t b = 0;
+  if (length <= 16) {
+    if (length >= 4) {
+      std::size_t shift = (length >> 3) << 2;
+      a = (FlatHashRead4(data) << 32) | FlatHashRead4(data + shift);
+      b = (FlatHashRead4(data + length - 4) << 32) |
+          FlatHashRead4(data + length - 4 - shift);
+    } else if (length > 0) {
+      a = (static_cast<std::uint64_t>(static_cast<unsigned char>(data[0])) << 16) |
+          (static_cast<std::uint64_t>(static_cast<unsigned char>(data[length >> 1])) << 8) |
+          static_cast<unsigned char>(data[length - 1]);
+    }
+  } else {
+    std::size_t remaining = length;
+    if (remaining > 48) {
+      std::uint64_t seed1 = seed;
+      std::uint64_t seed2 = seed;
+      do {
+        seed = FlatHashMix(FlatHashRead8(data) ^ secret[1],
+                           FlatHashRead8(data + 8) ^ seed);
+        seed1 = FlatHashMix(FlatHashRead8(data + 16) ^ secret[2],
+                            FlatHashRead8(data + 24) ^ seed1);
+        seed2 = FlatHashMix(FlatHashRead8(data + 32) ^ secret[3],
+                            FlatHashRead8(data + 40) ^ seed2);
+        data += 48;
+        remaining -= 48;
+      } while (remaining > 48);
+      seed ^= seed1 ^ seed2;
+    }
+    while (remaining > 16) {
+      seed = FlatHashMix(FlatHashRead8(data) ^ secret[1],
+                         FlatHashRead8(data + 8) ^ seed);
+      data += 16;
+      remaining -= 16;
+    }
+    a = FlatHashRead8(data + remaining - 16);
+    b = FlatHashRead8(data + remaining - 8);
+  }
+  a ^= secret[1];
+  b ^= seed;
+  FlatHashMultiply(a, b);
+  return FlatHashMix(a ^ secret[0] ^ length, b ^ secret[1]);
+}
+
+// Hash used by FlatHashMap. Strings hash their characters and are
+// transparent, so a std::string table can be probed with a string_view or
+// a string literal without building a std::string.
+template <typename T> 
+struct FlatHash {
+  std::size_t operator()(const T& value) const {
+    if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+      return FlatHashMix(static_cast<std::uint64_t>(value) ^ kFlatHashSecret[0],
+                         kFlatHashSecret[1]);
+    } else {
+      return FlatHashMix(std::hash<T>{}(value) ^ kFlatHashSecret[0],
+                         kFlatHashSecret[1]);
+    }
+  }
+};
+
+template <typename CharT, typename Traits, typename Alloc>
+struct FlatHash<std::basic_string<CharT, Traits, Alloc>> {
+  using is_transparent = void;
+
+  std::size_t operator()(std::basic_string_view<CharT, Traits> value) const {
+    return FlatHashBytes(value.data(), value.size() * sizeof(CharT));
+  }
+};
+
+template <typename CharT, typename Traits>
+struct FlatHash<std::basic_string_view<CharT, Traits>>
+    : FlatHash<std::basic_string<CharT, Traits>> {};
+
+// Open-addressing hash map with linear probing. Entries live in one
+// contiguous vector in insertion order, and the probe table stores entry
+// indices next to a copy of the hash, so a lookup touches the key itself
+// only on a full hash match. Lookups take any key type that Hash and Equal
+// accept, and try_emplace builds the stored Key only when the key is new.
+template <typename Key, typename Value, typename Hash = FlatHash<Key>,
+          typename Equal = std::equal_to<>>
+class FlatHashMap {
+public:
+  using key_type = Key;
+  using mapped_type = Value;
+  using value_type = std::pair<Key, Value>;
+  using iterator = typename std::pmr::vector<value_type>::iterator;
+  using const_iterator = typename std::pmr::vector<value_type>::const_iterator;
+
+  explicit FlatHashMap(std::pmr::memory_resource* resource =
+                           std::pmr::get_default_resource())
+      : entries_(resource), hashes_(resource), slots_(resource) {}
+
+  std::size_t size() const { return entries_.size(); }
+  bool empty() const { return entries_.empty(); }
+
+  void reserve(std::size_t count) {
+    entries_.reserve(count);
+    hashes_.reserve(count);
+    if (count * 2 > slots_.size()) {
+      rehash(count * 2);
+    }
+  }
+
+  template <typename K> 
+  iterator find(const K& key) {
+    std::size_t index = lookup(key, hash_(key));
+    return index == kMissing ? entries_.end() : entries_.begin() + index;
+  }
+
+  template <typename K> 
+  const_iterator find(const K& key) const {
+    std::size_t index = lookup(key, hash_(key));
+    return index == kMissing ? entries_.end() : entries_.begin() + index;
+  }
+
+  template <typename K> 
+  bool contains(const K& key) const {
+    return lookup(key, hash_(key)) != kMissing;
+  }
+
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+    if ((entries_.size() + 1) * 2 > slots_.size()) {
+      rehash(std::max<std::size_t>(16, slots_.size() * 2));
+    }
+    std::size_t hash = hash_(key);
+    std::size_t mask = slots_.size() - 1;
+    std::size_t pos = hash & mask;
+    for (; slots_[pos] != 0; pos = (pos + 1) & mask) {
+      std::size_t index = slots_[pos] - 1;
+      if (hashes_[index] == hash && equal_(entries_[index].first, key)) {
+        return {entries_.begin() + index, false};
+      }
+    }
+    entries_.emplace_back(std::piecewise_construct,
+                          std::forward_as_tuple(std::forward<K>(key)),
+                          std::forward_as_tuple(std::forward<Args>(args)...));
+    hashes_.push_back(hash);
+    slots_[pos] = entries_.size();
+    return {entries_.end() - 1, true};
+  }
+
+  template <typename K> 
+  Value& operator[](K&& key) {
+    return try_emplace(std::forward<K>(key)).first->second;
+  }
+
+  iterator begin() { return entries_.begin(); }
+  iterator end() { return entries_.end(); }
+  const_iterator begin() const { return entries_.begin(); }
+  const_iterator end() const { return entries_.end(); }
+
+  // Hands out the entries in insertion order and leaves the map empty.
+  std::pmr::vector<value_type> release() {
+    std::pmr::vector<value_type> entries = std::move(entries_);
+    entries_ = std::pmr::vector<value_type>(entries.get_allocator());
+    hashes_.clear();
+    std::fill(slots_.begin(), slots_.end(), 0);
+    return entries;
+  }
+
+private:
+  static constexpr std::size_t kMissing = static_cast<std::size_t>(-1);
+
+  std::pmr::vector<value_type> entries_;
+  std::pmr::vector<std::size_t> hashes_;
+  // Entry index + 1 for occupied slots, 0 for empty ones.
+  std::pmr::vector<std::size_t> slots_;
+  [[no_unique_address]] Hash hash_;
+  [[no_unique_address]] Equal equal_;
+
+  template <typename K> 
+  std::size_t lookup(const K& key, std::size_t hash) const {
+    if (slots_.empty()) {
+      return kMissing;
+    }
+    std::size_t mask = slots_.size() - 1;
+    for (std::size_t pos = hash & mask; slots_[pos] != 0;
+         pos = (pos + 1) & mask) {
+      std::size_t index = slots_[pos] - 1;
+      if (hashes_[index] == hash && equal_(entries_[index].first, key)) {
+        return index;
+      }
+    }
+    return kMissing;
+  }
+
+  void rehash(std::size_t minimum) {
+    std::size_t capacity = 16;
+    while (capacity < minimum) {
+      capacity *= 2;
+    }
+    slots_.assign(capacity, 0);
+    std::size_t mask = capacity - 1;
+    for (std::size_t index = 0; index < hashes_.size(); ++index) {
+      std::size_t pos = hashes_[index] & mask;
+      while (slots_[pos] != 0) {
+        pos = (pos + 1) & mask;
+      }
+      slots_[pos] = index + 1;
+    }
+  }
+};
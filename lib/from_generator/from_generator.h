@@ -0,0 +1,224 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <version>
+
+#if defined(__cpp_lib_generator)
+#include <generator>
+#endif
+
+// Minimal single-pass coroutine generator used when <generator> is not
+// available. Mutable lvalues and temporaries are yielded by reference:
+// the iterator points at the object named in co_yield, so nothing is copied
+// for them. A const lvalue is copied into the promise, since the iterator
+// hands out a mutable reference, and that copy may allocate per element.
+template <typename T> 
+class Generator {
+public:
+  using value_type = std::remove_cvref_t<T>;
+
+  class promise_type {
+  public:
+    Generator get_return_object() {
+      return Generator(
+          std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+
+    std::suspend_always yield_value(value_type& value) noexcept {
+      current_ = std::addressof(value);
+      return {};
+    }
+
+    // The temporary lives until the end of the co_yield expression, which
+    // spans the suspension.
+    std::suspend_always yield_value(value_type&& value) noexcept {
+      current_ = std::addressof(value);
+      return {};
+    }
+
+    std::suspend_always yield_value(const value_type& value) {
+      copy_.emplace(value);
+      current_ = std::addressof(*copy_);
+      return {};
+    }
+
+    void return_void() noexcept {}
+
+    void unhandled_exception() { exception_ = std::current_exception(); }
+
+    value_type& current() const { return *current_; }
+
+    void rethrowIfFailed() const {
+      if (exception_) {
+        std::rethrow_exception(exception_);
+      }
+    }
+
+  private:
+    value_type* current_ = nullptr;
+    std::optional<value_type> copy_;
+    std::exception_ptr exception_;
+  };
+
+  using handle_type = std::coroutine_handle<promise_type>;
+
+  class iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = typename Generator::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = value_type*;
+    using reference = value_type&;
+
+    explicit iterator(handle_type handle = nullptr) : handle_(handle) {}
+
+    reference operator*() const { return handle_.promise().current(); }
+
+    pointer operator->() const { return &handle_.promise().current(); }
+
+    iterator& operator++() {
+      handle_.resume();
+      handle_.promise().rethrowIfFailed();
+      return *this;
+    }
+
+    bool operator!=(const iterator& other) const {
+      return done() != other.done();
+    }
+
+    bool operator==(const iterator& other) const {
+      return done() == other.done();
+    }
+
+  private:
+    handle_type handle_;
+
+    bool done() const { return !handle_ || handle_.done(); }
+  };
+
+  using const_iterator = iterator;
+
+  Generator(Generator&& other) noexcept
+      : handle_(std::exchange(other.handle_, nullptr)) {}
+
+  Generator& operator=(Generator&& other) noexcept {
+    if (this != &other) {
+      destroy();
+      handle_ = std::exchange(other.handle_, nullptr);
+    }
+    return *this;
+  }
+
+  Generator(const Generator&) = delete;
+  Generator& operator=(const Generator&) = delete;
+
+  ~Generator() { destroy(); }
+
+  iterator begin() {
+    if (handle_ && !started_) {
+      started_ = true;
+      handle_.resume();
+      handle_.promise().rethrowIfFailed();
+    }
+    return iterator(handle_);
+  }
+
+  iterator end() { return iterator(); }
+
+private:
+  handle_type handle_;
+  bool started_ = false;
+
+  explicit Generator(handle_type handle) : handle_(handle) {}
+
+  void destroy() {
+    if (handle_) {
+      handle_.destroy();
+      handle_ = nullptr;
+    }
+  }
+};
+
+#if defined(__cpp_lib_generator)
+// std::generator iterators are move-only while adapters copy iterators,
+// so the range keeps the single live iterator and hands out pointers to it.
+template <typename StdGenerator> 
+class StdGeneratorRange {
+  using generator_iterator = decltype(std::declval<StdGenerator&>().begin());
+  using generator_reference = decltype(*std::declval<generator_iterator&>());
+
+public:
+  using value_type = std::remove_cvref_t<generator_reference>;
+
+  class iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = typename StdGeneratorRange::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::add_pointer_t<generator_reference>;
+    using reference = generator_reference;
+
+    explicit iterator(StdGeneratorRange* range = nullptr) : range_(range) {}
+
+    reference operator*() const { return **range_->current_; }
+
+    iterator& operator++() {
+      ++*range_->current_;
+      return *this;
+    }
+
+    bool operator!=(const iterator& other) const {
+      return done() != other.done();
+    }
+
+    bool operator==(const iterator& other) const {
+      return done() == other.done();
+    }
+
+  private:
+    StdGeneratorRange* range_;
+
+    bool done() const {
+      return range_ == nullptr || *range_->current_ == range_->generator_.end();
+    }
+  };
+
+  using const_iterator = iterator;
+
+  explicit StdGeneratorRange(StdGenerator generator)
+      : generator_(std::move(generator)) {}
+
+  iterator begin() {
+    if (!current_) {
+      current_.emplace(generator_.begin());
+    }
+    return iterator(this);
+  }
+
+  iterator end() { return iterator(); }
+
+private:
+  StdGenerator generator_;
+  std::optional<generator_iterator> current_;
+};
+
+template <typename Ref, typename V, typename Allocator>
+auto FromGenerator(std::generator<Ref, V, Allocator> generator) {
+  return StdGeneratorRange<std::generator<Ref, V, Allocator>>(
+      std::move(generator));
+}
+#endif
+
+template <typename T> 
+auto FromGenerator(Generator<T> generator) {
+  return generator;
+}
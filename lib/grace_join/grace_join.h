@@ -0,0 +1,309 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "from_generator/from_generator.h"
+#include "join/join.h"
+#include "materialize/materialize.h"
+
+inline constexpr std::size_t kGraceJoinMaxFanOut = 64;
+inline constexpr std::size_t kGraceJoinMaxLevels = 4;
+
+// Splits spilled entries into fan_out files by JoinPartition of their key
+// and tracks the estimated in-memory size of every partition.
+template <typename Entry> 
+class GraceJoinScatter {
+public:
+  GraceJoinScatter(const SpillDirectory& spill, const std::string& side,
+                   std::size_t& files, std::size_t fan_out, std::uint64_t seed)
+      : seed_(seed), bytes_(fan_out, 0) {
+    writers_.reserve(fan_out);
+    for (std::size_t i = 0; i < fan_out; ++i) {
+      writers_.emplace_back(spill.File(side, files++));
+    }
+  }
+
+  void Write(const Entry& entry) {
+    std::size_t partition = JoinPartition(entry.key, writers_.size(), seed_);
+    bytes_[partition] += EstimateMemoryUsage(entry);
+    writers_[partition].Write(entry);
+  }
+
+  std::vector<MaterializedRange<Entry>> Finish() {
+    std::vector<MaterializedRange<Entry>> partitions;
+    for (auto& writer : writers_) {
+      partitions.push_back(writer.Finish());
+    }
+    writers_.clear();
+    return partitions;
+  }
+
+  const std::vector<std::size_t>& Bytes() const { return bytes_; }
+
+private:
+  std::uint64_t seed_;
+  std::vector<std::size_t> bytes_;
+  std::vector<MaterializeWriter<Entry>> writers_;
+};
+
+// Hash join whose build side is held in memory only while it fits into
+// the budget. Past that point both sides are hash-partitioned into
+// budget.partitions spill files. A partition whose right side still
+// exceeds the budget is split again with another hash seed, into as many
+// parts as its size calls for, up to kGraceJoinMaxLevels times; only a
+// single key heavier than the budget is then built oversized. Each final
+// partition is joined with its right side in memory, and the rows, tagged
+// with their left position, go to a spill run; the runs are merged back
+// into left order, so the output is the same LEFT JOIN as Join's.
+// Spilled keys and values must be supported by Materialize.
+template <typename LeftRange, typename RightRange, typename KeyExtractorLeft,
+          typename KeyExtractorRight, typename ValueExtractorLeft,
+          typename ValueExtractorRight,
+          typename Iterator = JoinIterator<LeftRange, RightRange,
+                                           KeyExtractorLeft, KeyExtractorRight,
+                                           ValueExtractorLeft, ValueExtractorRight>>
+Generator<typename Iterator::value_type>
+GraceJoin(LeftRange left_range, RightRange right_range,
+          KeyExtractorLeft key_extractor_left,
+          KeyExtractorRight key_extractor_right,
+          ValueExtractorLeft value_extractor_left,
+          ValueExtractorRight value_extractor_right, MemoryBudget budget) {
+  using key_type = typename Iterator::key_type;
+  using left_value_type = typename Iterator::left_value_type;
+  using right_value_type = typename Iterator::right_value_type;
+  using value_type = typename Iterator::value_type;
+  using left_entry = KV<key_type, KV<std::uint64_t, left_value_type>>;
+  using right_entry = KV<key_type, right_value_type>;
+  // Left position, left value, whether there is a match, and the match.
+  using output_entry =
+      std::pair<std::uint64_t,
+                std::pair<left_value_type, std::pair<bool, right_value_type>>>;
+
+  std::vector<right_entry> buffer;
+  std::size_t used = 0;
+  std::optional<SpillDirectory> spill;
+  std::size_t files = 0;
+  std::optional<GraceJoinScatter<right_entry>> right_scatter;
+
+  for (const auto& item : right_range) {
+    right_entry entry{key_type(key_extractor_right(item)),
+                      value_extractor_right(item)};
+    if (right_scatter) {
+      right_scatter->Write(entry);
+      continue;
+    }
+    used += EstimateMemoryUsage(entry);
+    buffer.push_back(std::move(entry));
+    if (used > budget.bytes) {
+      spill.emplace(budget.spill_directory);
+      right_scatter.emplace(*spill, "right", files,
+                            std::max<std::size_t>(budget.partitions, 1), 0);
+      for (const auto& buffered : buffer) {
+        right_scatter->Write(buffered);
+      }
+      buffer = std::vector<right_entry>();
+    }
+  }
+
+  if (!spill) {
+    FlatJoinIndex<key_type, right_value_type> index;
+    for (auto& entry : buffer) {
+      index.Add(std::move(entry.key), std::move(entry.value));
+    }
+    buffer = std::vector<right_entry>();
+    index.Build();
+
+    for (const auto& item : left_range) {
+      value_type result{value_extractor_left(item), std::nullopt};
+      auto matches = index.Find(key_extractor_left(item));
+      if (matches.empty()) {
+        co_yield result;
+      }
+      for (const auto& match : matches) {
+        result.right = match;
+        co_yield result;
+      }
+    }
+    co_return;
+  }
+
+  struct Partition {
+    MaterializedRange<right_entry> right;
+    MaterializedRange<left_entry> left;
+    std::size_t right_bytes;
+    std::size_t level;
+  };
+
+  auto right_bytes = right_scatter->Bytes();
+  auto right_partitions = right_scatter->Finish();
+  right_scatter.reset();
+
+  GraceJoinScatter<left_entry> left_scatter(*spill, "left", files,
+                                            right_partitions.size(), 0);
+  std::uint64_t position = 0;
+  for (const auto& item : left_range) {
+    left_scatter.Write(left_entry{key_extractor_left(item),
+                                  {position++, value_extractor_left(item)}});
+  }
+  auto left_partitions = left_scatter.Finish();
+
+  std::vector<Partition> pending;
+  for (std::size_t i = right_partitions.size(); i-- > 0;) {
+    pending.push_back({std::move(right_partitions[i]),
+                       std::move(left_partitions[i]), right_bytes[i], 0});
+  }
+
+  std::vector<MaterializedRange<output_entry>> outputs;
+  while (!pending.empty()) {
+    std::vector<std::filesystem::path> consumed;
+    {
+      Partition partition = std::move(pending.back());
+      pending.pop_back();
+      consumed = {partition.right.path(), partition.left.path()};
+
+      if (partition.right_bytes > budget.bytes &&
+          partition.level < kGraceJoinMaxLevels) {
+        std::size_t fan_out = std::clamp<std::size_t>(
+            partition.right_bytes / std::max<std::size_t>(budget.bytes, 1) + 1,
+            2, kGraceJoinMaxFanOut);
+        std::uint64_t seed = partition.level + 1;
+
+        GraceJoinScatter<right_entry> right_split(*spill, "right", files,
+                                                  fan_out, seed);
+        for (const auto& entry : partition.right) {
+          right_split.Write(entry);
+        }
+        GraceJoinScatter<left_entry> left_split(*spill, "left", files, fan_out,
+                                                seed);
+        for (const auto& entry : partition.left) {
+          left_split.Write(entry);
+        }
+        auto split_bytes = right_split.Bytes();
+        auto split_right = right_split.Finish();
+        auto split_left = left_split.Finish();
+        for (std::size_t i = fan_out; i-- > 0;) {
+          pending.push_back({std::move(split_right[i]),
+                             std::move(split_left[i]), split_bytes[i],
+                             partition.level + 1});
+        }
+      } else {
+        FlatJoinIndex<key_type, right_value_type> index;
+        for (const auto& entry : partition.right) {
+          index.Add(entry.key, entry.value);
+        }
+        index.Build();
+
+        MaterializeWriter<output_entry> writer(spill->File("out", files++));
+        for (const auto& entry : partition.left) {
+          auto matches = index.Find(entry.key);
+          if (matches.empty()) {
+            writer.Write({entry.value.key,
+                          {entry.value.value, {false, right_value_type{}}}});
+          }
+          for (const auto& match : matches) {
+            writer.Write({entry.value.key, {entry.value.value, {true, match}}});
+          }
+        }
+        outputs.push_back(writer.Finish());
+      }
+    }
+    for (const auto& path : consumed) {
+      std::error_code error;
+      std::filesystem::remove(path, error);
+    }
+  }
+
+  auto by_position = [](const output_entry& lhs, const output_entry& rhs) {
+    return lhs.first < rhs.first;
+  };
+  outputs = ReduceRuns(std::move(outputs), by_position, *spill, "merge");
+  for (MaterializedMerge<output_entry, decltype(by_position)> merge(
+           outputs, by_position);
+       !merge.empty(); merge.pop()) {
+    auto& [left_position, row] = merge.top();
+    value_type result{std::move(row.first), std::nullopt};
+    if (row.second.first) {
+      result.right = std::move(row.second.second);
+    }
+    co_yield result;
+  }
+}
+
+template <typename RightRange, typename KeyExtractorLeft,
+          typename KeyExtractorRight, typename ValueExtractorLeft,
+          typename ValueExtractorRight>
+class GraceJoinAdapter {
+public:
+  GraceJoinAdapter(RightRange right_range, KeyExtractorLeft key_extractor_left,
+                   KeyExtractorRight key_extractor_right,
+                   ValueExtractorLeft value_extractor_left,
+                   ValueExtractorRight value_extractor_right,
+                   MemoryBudget budget)
+      : right_range_(std::move(right_range)),
+        key_extractor_left_(std::move(key_extractor_left)),
+        key_extractor_right_(std::move(key_extractor_right)),
+        value_extractor_left_(std::move(value_extractor_left)),
+        value_extractor_right_(std::move(value_extractor_right)),
+        budget_(std::move(budget)) {}
+
+  template <typename LeftRange> auto operator()(LeftRange&& left_range) const {
+    return GraceJoin<std::decay_t<LeftRange>, RightRange, KeyExtractorLeft,
+                     KeyExtractorRight, ValueExtractorLeft,
+                     ValueExtractorRight>(
+        std::forward<LeftRange>(left_range), right_range_, key_extractor_left_,
+        key_extractor_right_, value_extractor_left_, value_extractor_right_,
+        budget_);
+  }
+
+private:
+  RightRange right_range_;
+  KeyExtractorLeft key_extractor_left_;
+  KeyExtractorRight key_extractor_right_;
+  ValueExtractorLeft value_extractor_left_;
+  ValueExtractorRight value_extractor_right_;
+  MemoryBudget budget_;
+};
+
+template <typename RightRange>
+auto Join(RightRange&& right_range, MemoryBudget budget) {
+  using Element = typename std::decay_t<RightRange>::value_type;
+  return GraceJoinAdapter<std::decay_t<RightRange>, KeyExtractor<Element>,
+                          KeyExtractor<Element>, ValueExtractor<Element>,
+                          ValueExtractor<Element>>(
+      std::forward<RightRange>(right_range), KeyExtractor<Element>{},
+      KeyExtractor<Element>{}, ValueExtractor<Element>{},
+      ValueExtractor<Element>{}, std::move(budget));
+}
+
+template <typename RightRange, typename KeyExtractorLeft,
+          typename KeyExtractorRight>
+auto Join(RightRange&& right_range, KeyExtractorLeft key_extractor_left,
+          KeyExtractorRight key_extractor_right, MemoryBudget budget) {
+  using Element = typename std::decay_t<RightRange>::value_type;
+  return GraceJoinAdapter<std::decay_t<RightRange>, KeyExtractorLeft,
+                          KeyExtractorRight, IdentityExtractor<Element>,
+                          IdentityExtractor<Element>>(
+      std::forward<RightRange>(right_range), std::move(key_extractor_left),
+      std::move(key_extractor_right), IdentityExtractor<Element>{},
+      IdentityExtractor<Element>{}, std::move(budget));
+}
+
+template <typename LeftRange, typename RightRange, typename KeyExtractorLeft,
+          typename KeyExtractorRight, typename ValueExtractorLeft,
+          typename ValueExtractorRight>
+auto operator|(LeftRange&& left_range,
+               const GraceJoinAdapter<RightRange, KeyExtractorLeft,
+                                      KeyExtractorRight, ValueExtractorLeft,
+                                      ValueExtractorRight>& adapter) {
+  return adapter(std::forward<LeftRange>(left_range));
+}
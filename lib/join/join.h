@@ -1,11 +1,17 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <memory_resource>
 #include <optional>
+#include <span>
 #include <type_traits>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "flat_hash_map/flat_hash_map.h"
 
 template <typename K, typename V> 
 struct KV {
@@ -31,6 +37,19 @@ struct ValueExtractor {
   auto operator()(const T& kv) const { return kv.value; }
 };
 
+// Extractors for a left range whose element type is not known up front.
+template <> 
+struct KeyExtractor<void> {
+  template <typename T> 
+  auto operator()(const T& kv) const { return kv.key; }
+};
+
+template <> 
+struct ValueExtractor<void> {
+  template <typename T> 
+  auto operator()(const T& kv) const { return kv.value; }
+};
+
 template <typename T> 
 struct IdentityExtractor {
   template <typename U> 
@@ -39,21 +58,166 @@ struct IdentityExtractor {
   }
 };
 
-template <typename LeftRange, typename RightRange, typename KeyExtractorLeft,
-          typename KeyExtractorRight, typename ValueExtractorLeft,
-          typename ValueExtractorRight>
-class JoinIterator {
+// Maps a key to one of `partitions` buckets. FlatJoinIndex probes with the
+// low hash bits, so partitions take the high ones to keep each partition's
+// keys spread over its table. A nonzero seed rehashes the key, so an
+// oversized partition can be split again independently of the first split.
+template <typename Key>
+std::size_t JoinPartition(const Key& key, std::size_t partitions,
+                          std::uint64_t seed = 0) {
+  std::uint64_t hash = FlatHash<Key>{}(key);
+  if (seed != 0) {
+    hash = FlatHashMix(hash ^ kFlatHashSecret[2], seed ^ kFlatHashSecret[3]);
+  }
+  return static_cast<std::size_t>(((hash >> 32) * partitions) >> 32);
+}
+
+// Build side of a hash join. Right values are grouped by key into one
+// contiguous array and an open-addressing table maps each key to its
+// group, so a probe yields a span over the matches without copying.
+template <typename Key, typename Value>
+class FlatJoinIndex {
 public:
-  using key_type = std::decay_t<decltype(std::declval<KeyExtractorLeft>()(
-      *std::declval<typename LeftRange::iterator>()))>;
+  using key_type = Key;
+  using value_type = Value;
+
+  explicit FlatJoinIndex(std::pmr::memory_resource* resource =
+                             std::pmr::get_default_resource())
+      : keys_(resource), hashes_(resource), offsets_(resource),
+        values_(resource), slots_(resource), staged_(resource),
+        staged_groups_(resource) {}
+
+  template <typename K, typename V>
+  void Add(K&& key, V&& value) {
+    staged_groups_.push_back(findOrInsert(std::forward<K>(key)));
+    staged_.push_back(std::forward<V>(value));
+  }
+
+  // Groups the staged values by key in place: each value's group is
+  // replaced by its final position, and the values are then permuted by
+  // following cycles, so no second copy of the right side is made. Must be
+  // called once after the last Add() and before the first Find().
+  void Build() {
+    offsets_.assign(keys_.size() + 1, 0);
+    for (auto group : staged_groups_) {
+      ++offsets_[group + 1];
+    }
+    for (std::size_t i = 1; i < offsets_.size(); ++i) {
+      offsets_[i] += offsets_[i - 1];
+    }
+
+    std::pmr::vector<std::size_t> cursor(offsets_.begin(), offsets_.end() - 1,
+                                         offsets_.get_allocator());
+    std::pmr::vector<std::size_t>& target = staged_groups_;
+    for (auto& position : target) {
+      position = cursor[position]++;
+    }
+    cursor = std::pmr::vector<std::size_t>(cursor.get_allocator());
+
+    for (std::size_t i = 0; i < staged_.size(); ++i) {
+      while (target[i] != i) {
+        std::size_t next = target[i];
+        std::swap(staged_[i], staged_[next]);
+        std::swap(target[i], target[next]);
+      }
+    }
+
+    values_ = std::move(staged_);
+    staged_ = std::pmr::vector<Value>(values_.get_allocator());
+    staged_groups_ = std::pmr::vector<std::size_t>(staged_groups_.get_allocator());
+  }
+
+  std::span<const Value> Find(const Key& key) const {
+    if (slots_.empty()) {
+      return {};
+    }
+    std::size_t hash = FlatHash<Key>{}(key);
+    std::size_t mask = slots_.size() - 1;
+    for (std::size_t pos = hash & mask; slots_[pos] != 0; pos = (pos + 1) & mask) {
+      std::size_t group = slots_[pos] - 1;
+      if (hashes_[group] == hash && keys_[group] == key) {
+        return std::span<const Value>(values_.data() + offsets_[group],
+                                      offsets_[group + 1] - offsets_[group]);
+      }
+    }
+    return {};
+  }
+
+  std::size_t KeyCount() const { return keys_.size(); }
+  std::size_t ValueCount() const { return values_.size(); }
+
+  // All values grouped by key; spans returned by Find() point into it.
+  std::span<const Value> Values() const { return values_; }
+
+  // Calls func(key, values) for every key in insertion order.
+  template <typename Func> 
+  void ForEachGroup(Func&& func) const {
+    for (std::size_t group = 0; group < keys_.size(); ++group) {
+      func(keys_[group],
+           std::span<const Value>(values_.data() + offsets_[group],
+                                  offsets_[group + 1] - offsets_[group]));
+    }
+  }
+
+private:
+  std::pmr::vector<Key> keys_;
+  std::pmr::vector<std::size_t> hashes_;
+  std::pmr::vector<std::size_t> offsets_;
+  std::pmr::vector<Value> values_;
+  // Group index + 1 for occupied slots, 0 for empty ones.
+  std::pmr::vector<std::size_t> slots_;
+  std::pmr::vector<Value> staged_;
+  std::pmr::vector<std::size_t> staged_groups_;
+
+  template <typename K>
+  std::size_t findOrInsert(K&& key) {
+    if ((keys_.size() + 1) * 2 > slots_.size()) {
+      grow();
+    }
+    std::size_t hash = FlatHash<Key>{}(key);
+    std::size_t mask = slots_.size() - 1;
+    std::size_t pos = hash & mask;
+    for (; slots_[pos] != 0; pos = (pos + 1) & mask) {
+      std::size_t group = slots_[pos] - 1;
+      if (hashes_[group] == hash && keys_[group] == key) {
+        return group;
+      }
+    }
+    keys_.push_back(std::forward<K>(key));
+    hashes_.push_back(hash);
+    slots_[pos] = keys_.size();
+    return keys_.size() - 1;
+  }
+
+  void grow() {
+    std::size_t capacity = slots_.empty() ? 16 : slots_.size() * 2;
+    slots_.assign(capacity, 0);
+    std::size_t mask = capacity - 1;
+    for (std::size_t group = 0; group < keys_.size(); ++group) {
+      std::size_t pos = hashes_[group] & mask;
+      while (slots_[pos] != 0) {
+        pos = (pos + 1) & mask;
+      }
+      slots_[pos] = group + 1;
+    }
+  }
+};
+
+// Probes an index with the keys of a left range. Index provides key_type,
+// value_type and a Find(key) that returns a default-constructible view of
+// the matching values with size(), empty() and operator[].
+template <typename LeftRange, typename Index, typename KeyExtractorLeft,
+          typename ValueExtractorLeft>
+class IndexJoinIterator {
+public:
+  using index_type = Index;
+  using key_type = typename Index::key_type;
 
   using left_value_type =
       std::decay_t<decltype(std::declval<ValueExtractorLeft>()(
           *std::declval<typename LeftRange::iterator>()))>;
 
-  using right_value_type =
-      std::decay_t<decltype(std::declval<ValueExtractorRight>()(
-          *std::declval<typename RightRange::iterator>()))>;
+  using right_value_type = typename Index::value_type;
 
   using iterator_category = std::input_iterator_tag;
   using value_type = JoinResult<left_value_type, right_value_type>;
@@ -61,29 +225,28 @@ public:
   using pointer = const value_type *;
   using reference = const value_type &;
 
-  JoinIterator(typename LeftRange::iterator left_it,
-               typename LeftRange::iterator left_end,
-               const std::unordered_map<key_type, std::vector<right_value_type>>& right_index,
-               KeyExtractorLeft key_extractor_left,
-               ValueExtractorLeft value_extractor_left)
-      : left_it_(left_it), left_end_(left_end), right_index_(right_index),
+  IndexJoinIterator(typename LeftRange::iterator left_it,
+                    typename LeftRange::iterator left_end,
+                    const index_type& right_index,
+                    KeyExtractorLeft key_extractor_left,
+                    ValueExtractorLeft value_extractor_left)
+      : left_it_(left_it), left_end_(left_end), right_index_(&right_index),
         key_extractor_left_(key_extractor_left),
-        value_extractor_left_(value_extractor_left), right_values_(),
+        value_extractor_left_(value_extractor_left),
         right_index_pos_(0) {
     if (left_it_ != left_end_) {
       updateRightValues();
     }
   }
 
-  JoinIterator() = default;
+  IndexJoinIterator() = default;
 
   reference operator*() const { return current_; }
 
-  JoinIterator &operator++() {
+  IndexJoinIterator &operator++() {
     if (right_index_pos_ + 1 < right_values_.size()) {
       right_index_pos_++;
-      current_ = JoinResult<left_value_type, right_value_type>{
-          value_extractor_left_(*left_it_), right_values_[right_index_pos_]};
+      current_.right = right_values_[right_index_pos_];
     } else {
       ++left_it_;
       right_index_pos_ = 0;
@@ -94,7 +257,7 @@ public:
     return *this;
   }
 
-  bool operator!=(const JoinIterator &other) const {
+  bool operator!=(const IndexJoinIterator &other) const {
     return left_it_ != other.left_it_ ||
            (left_it_ != left_end_ && other.left_it_ != other.left_end_ &&
             right_index_pos_ != other.right_index_pos_);
@@ -103,33 +266,39 @@ public:
 private:
   typename LeftRange::iterator left_it_;
   typename LeftRange::iterator left_end_;
-  const std::unordered_map<key_type, std::vector<right_value_type>>& right_index_;
+  const index_type* right_index_ = nullptr;
   KeyExtractorLeft key_extractor_left_;
   ValueExtractorLeft value_extractor_left_;
-  std::vector<right_value_type> right_values_;
-  size_t right_index_pos_;
+  decltype(std::declval<const Index&>().Find(std::declval<const key_type&>()))
+      right_values_;
+  size_t right_index_pos_ = 0;
   value_type current_;
 
   void updateRightValues() {
-    auto key = key_extractor_left_(*left_it_);
-    auto it = right_index_.find(key);
-    if (it != right_index_.end()) {
-      right_values_ = it->second;
-      if (!right_values_.empty()) {
-        current_ = JoinResult<left_value_type, right_value_type>{
-            value_extractor_left_(*left_it_), right_values_[right_index_pos_]};
-      } else {
-        current_ = JoinResult<left_value_type, right_value_type>{
-            value_extractor_left_(*left_it_), std::nullopt};
-      }
+    right_values_ = right_index_->Find(key_extractor_left_(*left_it_));
+    if (!right_values_.empty()) {
+      current_ = JoinResult<left_value_type, right_value_type>{
+          value_extractor_left_(*left_it_), right_values_[right_index_pos_]};
     } else {
-      right_values_.clear();
       current_ = JoinResult<left_value_type, right_value_type>{
           value_extractor_left_(*left_it_), std::nullopt};
     }
   }
 };
 
+// Iterator of the hash join built by JoinRange: the right side is indexed
+// by the left key type.
+template <typename LeftRange, typename RightRange, typename KeyExtractorLeft,
+          typename KeyExtractorRight, typename ValueExtractorLeft,
+          typename ValueExtractorRight>
+using JoinIterator = IndexJoinIterator<
+    LeftRange,
+    FlatJoinIndex<std::decay_t<decltype(std::declval<KeyExtractorLeft>()(
+                      *std::declval<typename LeftRange::iterator>()))>,
+                  std::decay_t<decltype(std::declval<ValueExtractorRight>()(
+                      *std::declval<typename RightRange::iterator>()))>>,
+    KeyExtractorLeft, ValueExtractorLeft>;
+
 template <typename LeftRange, typename RightRange, typename KeyExtractorLeft,
           typename KeyExtractorRight, typename ValueExtractorLeft,
           typename ValueExtractorRight>
@@ -147,14 +316,17 @@ public:
             KeyExtractorLeft key_extractor_left,
             KeyExtractorRight key_extractor_right,
             ValueExtractorLeft value_extractor_left,
-            ValueExtractorRight value_extractor_right)
+            ValueExtractorRight value_extractor_right,
+            std::pmr::memory_resource* resource =
+                std::pmr::get_default_resource())
       : left_range_(std::move(left_range)),
         key_extractor_left_(std::move(key_extractor_left)),
-        value_extractor_left_(std::move(value_extractor_left)), right_index_() {
+        value_extractor_left_(std::move(value_extractor_left)),
+        right_index_(resource) {
     for (const auto& item : right_range) {
-      right_index_[key_extractor_right(item)].push_back(
-          value_extractor_right(item));
+      right_index_.Add(key_extractor_right(item), value_extractor_right(item));
     }
+    right_index_.Build();
   }
 
   iterator begin() {
@@ -171,7 +343,131 @@ private:
   LeftRange left_range_;
   KeyExtractorLeft key_extractor_left_;
   ValueExtractorLeft value_extractor_left_;
-  std::unordered_map<key_type, std::vector<right_value_type>> right_index_;
+  typename iterator::index_type right_index_;
+};
+
+// Immutable hash index over a right range, built once and shared by every
+// Join(index) that probes it. Copies share the same index, and probing
+// does not modify it, so many pipelines may use one index concurrently.
+template <typename Key, typename Value> 
+class JoinIndex {
+public:
+  using key_type = Key;
+  using value_type = Value;
+
+  explicit JoinIndex(std::shared_ptr<const FlatJoinIndex<Key, Value>> index)
+      : index_(std::move(index)) {}
+
+  std::span<const Value> Find(const Key& key) const { return index_->Find(key); }
+
+  std::size_t KeyCount() const { return index_->KeyCount(); }
+  std::size_t ValueCount() const { return index_->ValueCount(); }
+
+  template <typename Func> 
+  void ForEachGroup(Func&& func) const {
+    index_->ForEachGroup(std::forward<Func>(func));
+  }
+
+private:
+  std::shared_ptr<const FlatJoinIndex<Key, Value>> index_;
+};
+
+template <typename T> 
+struct IsJoinIndex : std::false_type {};
+
+template <typename Key, typename Value> 
+struct IsJoinIndex<JoinIndex<Key, Value>> : std::true_type {};
+
+template <typename RightRange, typename KeyExtractorRight,
+          typename ValueExtractorRight>
+auto BuildJoinIndex(RightRange&& right_range,
+                    KeyExtractorRight key_extractor_right,
+                    ValueExtractorRight value_extractor_right,
+                    std::pmr::memory_resource* resource =
+                        std::pmr::get_default_resource()) {
+  using Element = decltype(*right_range.begin());
+  using key_type =
+      std::decay_t<std::invoke_result_t<KeyExtractorRight&, Element>>;
+  using value_type =
+      std::decay_t<std::invoke_result_t<ValueExtractorRight&, Element>>;
+
+  auto index = std::make_shared<FlatJoinIndex<key_type, value_type>>(resource);
+  for (const auto& item : right_range) {
+    index->Add(key_extractor_right(item), value_extractor_right(item));
+  }
+  index->Build();
+  return JoinIndex<key_type, value_type>(std::move(index));
+}
+
+template <typename RightRange> 
+auto BuildJoinIndex(RightRange&& right_range) {
+  using Element = typename std::decay_t<RightRange>::value_type;
+  return BuildJoinIndex(std::forward<RightRange>(right_range),
+                        KeyExtractor<Element>{}, ValueExtractor<Element>{});
+}
+
+template <typename RightRange, typename KeyExtractorRight>
+auto BuildJoinIndex(RightRange&& right_range,
+                    KeyExtractorRight key_extractor_right) {
+  using Element = typename std::decay_t<RightRange>::value_type;
+  return BuildJoinIndex(std::forward<RightRange>(right_range),
+                        std::move(key_extractor_right),
+                        IdentityExtractor<Element>{});
+}
+
+template <typename LeftRange, typename Index, typename KeyExtractorLeft,
+          typename ValueExtractorLeft>
+class IndexJoinRange {
+public:
+  using iterator = IndexJoinIterator<LeftRange, Index, KeyExtractorLeft,
+                                     ValueExtractorLeft>;
+  using value_type = typename iterator::value_type;
+
+  IndexJoinRange(LeftRange left_range, Index index,
+                 KeyExtractorLeft key_extractor_left,
+                 ValueExtractorLeft value_extractor_left)
+      : left_range_(std::move(left_range)), index_(std::move(index)),
+        key_extractor_left_(std::move(key_extractor_left)),
+        value_extractor_left_(std::move(value_extractor_left)) {}
+
+  iterator begin() {
+    return iterator(left_range_.begin(), left_range_.end(), index_,
+                    key_extractor_left_, value_extractor_left_);
+  }
+
+  iterator end() {
+    return iterator(left_range_.end(), left_range_.end(), index_,
+                    key_extractor_left_, value_extractor_left_);
+  }
+
+private:
+  LeftRange left_range_;
+  Index index_;
+  KeyExtractorLeft key_extractor_left_;
+  ValueExtractorLeft value_extractor_left_;
+};
+
+template <typename Index, typename KeyExtractorLeft,
+          typename ValueExtractorLeft>
+class IndexJoinAdapter {
+public:
+  IndexJoinAdapter(Index index, KeyExtractorLeft key_extractor_left,
+                   ValueExtractorLeft value_extractor_left)
+      : index_(std::move(index)),
+        key_extractor_left_(std::move(key_extractor_left)),
+        value_extractor_left_(std::move(value_extractor_left)) {}
+
+  template <typename LeftRange> auto operator()(LeftRange&& left_range) const {
+    return IndexJoinRange<std::decay_t<LeftRange>, Index, KeyExtractorLeft,
+                          ValueExtractorLeft>(
+        std::forward<LeftRange>(left_range), index_, key_extractor_left_,
+        value_extractor_left_);
+  }
+
+private:
+  Index index_;
+  KeyExtractorLeft key_extractor_left_;
+  ValueExtractorLeft value_extractor_left_;
 };
 
 template <typename RightRange,
@@ -194,19 +490,22 @@ public:
       ValueExtractorLeft value_extractor_left =
           ValueExtractor<typename std::decay_t<RightRange>::value_type>{},
       ValueExtractorRight value_extractor_right =
-          ValueExtractor<typename std::decay_t<RightRange>::value_type>{})
+          ValueExtractor<typename std::decay_t<RightRange>::value_type>{},
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource())
       : right_range_(std::move(right_range)),
         key_extractor_left_(std::move(key_extractor_left)),
         key_extractor_right_(std::move(key_extractor_right)),
         value_extractor_left_(std::move(value_extractor_left)),
-        value_extractor_right_(std::move(value_extractor_right)) {}
+        value_extractor_right_(std::move(value_extractor_right)),
+        resource_(resource) {}
 
   template <typename LeftRange> auto operator()(LeftRange&& left_range) const {
     return JoinRange<std::decay_t<LeftRange>, RightRange, KeyExtractorLeft,
                      KeyExtractorRight, ValueExtractorLeft,
                      ValueExtractorRight>(
         std::forward<LeftRange>(left_range), right_range_, key_extractor_left_,
-        key_extractor_right_, value_extractor_left_, value_extractor_right_);
+        key_extractor_right_, value_extractor_left_, value_extractor_right_,
+        resource_);
   }
 
 private:
@@ -215,17 +514,32 @@ private:
   KeyExtractorRight key_extractor_right_;
   ValueExtractorLeft value_extractor_left_;
   ValueExtractorRight value_extractor_right_;
+  std::pmr::memory_resource* resource_;
 };
 
-template <typename RightRange> auto Join(RightRange&& right_range) {
+template <typename RightRange>
+  requires(!IsJoinIndex<std::decay_t<RightRange>>::value)
+auto Join(RightRange&& right_range) {
   return JoinAdapter<std::decay_t<RightRange>>(
       std::forward<RightRange>(right_range));
 }
 
+// The right-side hash index is allocated from the given resource.
+template <typename RightRange>
+auto Join(RightRange&& right_range, std::pmr::memory_resource* resource) {
+  using Element = typename std::decay_t<RightRange>::value_type;
+  return JoinAdapter<std::decay_t<RightRange>>(
+      std::forward<RightRange>(right_range), KeyExtractor<Element>{},
+      KeyExtractor<Element>{}, ValueExtractor<Element>{},
+      ValueExtractor<Element>{}, resource);
+}
+
 template <typename RightRange, typename KeyExtractorLeft,
           typename KeyExtractorRight>
 auto Join(RightRange&& right_range, KeyExtractorLeft key_extractor_left,
-          KeyExtractorRight key_extractor_right) {
+          KeyExtractorRight key_extractor_right,
+          std::pmr::memory_resource* resource =
+              std::pmr::get_default_resource()) {
   return JoinAdapter<
       std::decay_t<RightRange>, KeyExtractorLeft, KeyExtractorRight,
       IdentityExtractor<typename std::decay_t<RightRange>::value_type>,
@@ -233,7 +547,22 @@ auto Join(RightRange&& right_range, KeyExtractorLeft key_extractor_left,
       std::forward<RightRange>(right_range), std::move(key_extractor_left),
       std::move(key_extractor_right),
       IdentityExtractor<typename std::decay_t<RightRange>::value_type>{},
-      IdentityExtractor<typename std::decay_t<RightRange>::value_type>{});
+      IdentityExtractor<typename std::decay_t<RightRange>::value_type>{},
+      resource);
+}
+
+template <typename Index>
+  requires IsJoinIndex<Index>::value
+auto Join(const Index& index) {
+  return IndexJoinAdapter<Index, KeyExtractor<void>, ValueExtractor<void>>(
+      index, KeyExtractor<void>{}, ValueExtractor<void>{});
+}
+
+template <typename Index, typename KeyExtractorLeft>
+  requires IsJoinIndex<Index>::value
+auto Join(const Index& index, KeyExtractorLeft key_extractor_left) {
+  return IndexJoinAdapter<Index, KeyExtractorLeft, IdentityExtractor<void>>(
+      index, std::move(key_extractor_left), IdentityExtractor<void>{});
 }
 
 template <typename LeftRange, typename RightRange, typename KeyExtractorLeft,
@@ -244,4 +573,12 @@ auto operator|(
     const JoinAdapter<RightRange, KeyExtractorLeft, KeyExtractorRight,
                       ValueExtractorLeft, ValueExtractorRight>& join_adapter) {
   return join_adapter(std::forward<LeftRange>(left_range));
+}
+
+template <typename LeftRange, typename Index, typename KeyExtractorLeft,
+          typename ValueExtractorLeft>
+auto operator|(LeftRange&& left_range,
+               const IndexJoinAdapter<Index, KeyExtractorLeft,
+                                      ValueExtractorLeft>& adapter) {
+  return adapter(std::forward<LeftRange>(left_range));
 }
\ No newline at end of file
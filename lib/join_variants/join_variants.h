@@ -0,0 +1,315 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "join/join.h"
+
+template <typename LeftType, typename RightType> 
+struct OuterJoinResult {
+  std::optional<LeftType> left;
+  std::optional<RightType> right;
+
+  bool operator==(const OuterJoinResult& other) const = default;
+};
+
+enum class JoinKind { Inner, Right, Full };
+
+// One probe pass over the left range against a FlatJoinIndex of the right
+// one. Every right row that is hit is flagged in a bitmap; for Right and
+// Full joins the rows left unflagged are emitted after the left range is
+// exhausted. Inner joins yield JoinResult, the others OuterJoinResult.
+template <JoinKind Kind, typename LeftRange, typename RightRange,
+          typename KeyExtractorLeft, typename KeyExtractorRight,
+          typename ValueExtractorLeft, typename ValueExtractorRight>
+class KindJoinIterator {
+public:
+  using key_type = std::decay_t<decltype(std::declval<KeyExtractorLeft>()(
+      *std::declval<typename LeftRange::iterator>()))>;
+
+  using left_value_type =
+      std::decay_t<decltype(std::declval<ValueExtractorLeft>()(
+          *std::declval<typename LeftRange::iterator>()))>;
+
+  using right_value_type =
+      std::decay_t<decltype(std::declval<ValueExtractorRight>()(
+          *std::declval<typename RightRange::iterator>()))>;
+
+  using index_type = FlatJoinIndex<key_type, right_value_type>;
+
+  using iterator_category = std::input_iterator_tag;
+  using value_type =
+      std::conditional_t<Kind == JoinKind::Inner,
+                         JoinResult<left_value_type, right_value_type>,
+                         OuterJoinResult<left_value_type, right_value_type>>;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const value_type *;
+  using reference = const value_type &;
+
+  KindJoinIterator(typename LeftRange::iterator left_it,
+                   typename LeftRange::iterator left_end,
+                   const index_type& right_index, std::vector<bool>& matched,
+                   KeyExtractorLeft key_extractor_left,
+                   ValueExtractorLeft value_extractor_left, bool at_end)
+      : left_it_(left_it), left_end_(left_end), right_index_(&right_index),
+        matched_(&matched), key_extractor_left_(key_extractor_left),
+        value_extractor_left_(value_extractor_left) {
+    if (at_end) {
+      right_pos_ = right_index_->ValueCount();
+    } else {
+      advanceLeft();
+    }
+  }
+
+  reference operator*() const { return current_; }
+
+  KindJoinIterator &operator++() {
+    if (left_it_ != left_end_) {
+      if (match_pos_ + 1 < matches_.size()) {
+        ++match_pos_;
+        emitMatch();
+      } else {
+        ++left_it_;
+        advanceLeft();
+      }
+    } else {
+      ++right_pos_;
+      advanceUnmatched();
+    }
+    return *this;
+  }
+
+  bool operator!=(const KindJoinIterator &other) const {
+    return left_it_ != other.left_it_ || match_pos_ != other.match_pos_ ||
+           right_pos_ != other.right_pos_;
+  }
+
+private:
+  typename LeftRange::iterator left_it_;
+  typename LeftRange::iterator left_end_;
+  const index_type* right_index_;
+  std::vector<bool>* matched_;
+  KeyExtractorLeft key_extractor_left_;
+  ValueExtractorLeft value_extractor_left_;
+  std::span<const right_value_type> matches_;
+  size_t match_pos_ = 0;
+  size_t right_pos_ = 0;
+  value_type current_;
+
+  void advanceLeft() {
+    for (; left_it_ != left_end_; ++left_it_) {
+      matches_ = right_index_->Find(key_extractor_left_(*left_it_));
+      match_pos_ = 0;
+      if (!matches_.empty()) {
+        emitMatch();
+        return;
+      }
+      if constexpr (Kind == JoinKind::Full) {
+        current_ = value_type{value_extractor_left_(*left_it_), std::nullopt};
+        return;
+      }
+    }
+    matches_ = {};
+    match_pos_ = 0;
+    right_pos_ = 0;
+    advanceUnmatched();
+  }
+
+  void advanceUnmatched() {
+    std::size_t count = right_index_->ValueCount();
+    if constexpr (Kind == JoinKind::Inner) {
+      right_pos_ = count;
+    } else {
+      while (right_pos_ < count && (*matched_)[right_pos_]) {
+        ++right_pos_;
+      }
+      if (right_pos_ < count) {
+        current_ = value_type{std::nullopt, right_index_->Values()[right_pos_]};
+      }
+    }
+  }
+
+  void emitMatch() {
+    (*matched_)[matches_.data() - right_index_->Values().data() + match_pos_] =
+        true;
+    current_ =
+        value_type{value_extractor_left_(*left_it_), matches_[match_pos_]};
+  }
+};
+
+template <JoinKind Kind, typename LeftRange, typename RightRange,
+          typename KeyExtractorLeft, typename KeyExtractorRight,
+          typename ValueExtractorLeft, typename ValueExtractorRight>
+class KindJoinRange {
+public:
+  using iterator =
+      KindJoinIterator<Kind, LeftRange, RightRange, KeyExtractorLeft,
+                       KeyExtractorRight, ValueExtractorLeft,
+                       ValueExtractorRight>;
+  using value_type = typename iterator::value_type;
+
+  KindJoinRange(LeftRange left_range, const RightRange& right_range,
+                KeyExtractorLeft key_extractor_left,
+                KeyExtractorRight key_extractor_right,
+                ValueExtractorLeft value_extractor_left,
+                ValueExtractorRight value_extractor_right,
+                std::pmr::memory_resource* resource)
+      : left_range_(std::move(left_range)),
+        key_extractor_left_(std::move(key_extractor_left)),
+        value_extractor_left_(std::move(value_extractor_left)),
+        right_index_(resource) {
+    for (const auto& item : right_range) {
+      right_index_.Add(key_extractor_right(item), value_extractor_right(item));
+    }
+    right_index_.Build();
+  }
+
+  iterator begin() {
+    matched_.assign(right_index_.ValueCount(), false);
+    return iterator(left_range_.begin(), left_range_.end(), right_index_,
+                    matched_, key_extractor_left_, value_extractor_left_,
+                    false);
+  }
+
+  iterator end() {
+    return iterator(left_range_.end(), left_range_.end(), right_index_,
+                    matched_, key_extractor_left_, value_extractor_left_, true);
+  }
+
+private:
+  LeftRange left_range_;
+  KeyExtractorLeft key_extractor_left_;
+  ValueExtractorLeft value_extractor_left_;
+  typename iterator::index_type right_index_;
+  std::vector<bool> matched_;
+};
+
+template <JoinKind Kind, typename RightRange, typename KeyExtractorLeft,
+          typename KeyExtractorRight, typename ValueExtractorLeft,
+          typename ValueExtractorRight>
+class KindJoinAdapter {
+public:
+  KindJoinAdapter(RightRange right_range, KeyExtractorLeft key_extractor_left,
+                  KeyExtractorRight key_extractor_right,
+                  ValueExtractorLeft value_extractor_left,
+                  ValueExtractorRight value_extractor_right,
+                  std::pmr::memory_resource* resource)
+      : right_range_(std::move(right_range)),
+        key_extractor_left_(std::move(key_extractor_left)),
+        key_extractor_right_(std::move(key_extractor_right)),
+        value_extractor_left_(std::move(value_extractor_left)),
+        value_extractor_right_(std::move(value_extractor_right)),
+        resource_(resource) {}
+
+  template <typename LeftRange> auto operator()(LeftRange&& left_range) const {
+    return KindJoinRange<Kind, std::decay_t<LeftRange>, RightRange,
+                         KeyExtractorLeft, KeyExtractorRight,
+                         ValueExtractorLeft, ValueExtractorRight>(
+        std::forward<LeftRange>(left_range), right_range_, key_extractor_left_,
+        key_extractor_right_, value_extractor_left_, value_extractor_right_,
+        resource_);
+  }
+
+private:
+  RightRange right_range_;
+  KeyExtractorLeft key_extractor_left_;
+  KeyExtractorRight key_extractor_right_;
+  ValueExtractorLeft value_extractor_left_;
+  ValueExtractorRight value_extractor_right_;
+  std::pmr::memory_resource* resource_;
+};
+
+template <JoinKind Kind, typename RightRange>
+auto MakeKindJoin(RightRange&& right_range,
+                  std::pmr::memory_resource* resource) {
+  using Element = typename std::decay_t<RightRange>::value_type;
+  return KindJoinAdapter<Kind, std::decay_t<RightRange>, KeyExtractor<Element>,
+                         KeyExtractor<Element>, ValueExtractor<Element>,
+                         ValueExtractor<Element>>(
+      std::forward<RightRange>(right_range), KeyExtractor<Element>{},
+      KeyExtractor<Element>{}, ValueExtractor<Element>{},
+      ValueExtractor<Element>{}, resource);
+}
+
+template <JoinKind Kind, typename RightRange, typename KeyExtractorLeft,
+          typename KeyExtractorRight>
+auto MakeKindJoin(RightRange&& right_range, KeyExtractorLeft key_extractor_left,
+                  KeyExtractorRight key_extractor_right,
+                  std::pmr::memory_resource* resource) {
+  using Element = typename std::decay_t<RightRange>::value_type;
+  return KindJoinAdapter<Kind, std::decay_t<RightRange>, KeyExtractorLeft,
+                         KeyExtractorRight, IdentityExtractor<Element>,
+                         IdentityExtractor<Element>>(
+      std::forward<RightRange>(right_range), std::move(key_extractor_left),
+      std::move(key_extractor_right), IdentityExtractor<Element>{},
+      IdentityExtractor<Element>{}, resource);
+}
+
+template <typename RightRange>
+auto InnerJoin(RightRange&& right_range, std::pmr::memory_resource* resource =
+                                             std::pmr::get_default_resource()) {
+  return MakeKindJoin<JoinKind::Inner>(std::forward<RightRange>(right_range),
+                                       resource);
+}
+
+template <typename RightRange, typename KeyExtractorLeft,
+          typename KeyExtractorRight>
+auto InnerJoin(RightRange&& right_range, KeyExtractorLeft key_extractor_left,
+               KeyExtractorRight key_extractor_right,
+               std::pmr::memory_resource* resource =
+                   std::pmr::get_default_resource()) {
+  return MakeKindJoin<JoinKind::Inner>(
+      std::forward<RightRange>(right_range), std::move(key_extractor_left),
+      std::move(key_extractor_right), resource);
+}
+
+template <typename RightRange>
+auto RightJoin(RightRange&& right_range, std::pmr::memory_resource* resource =
+                                             std::pmr::get_default_resource()) {
+  return MakeKindJoin<JoinKind::Right>(std::forward<RightRange>(right_range),
+                                       resource);
+}
+
+template <typename RightRange, typename KeyExtractorLeft,
+          typename KeyExtractorRight>
+auto RightJoin(RightRange&& right_range, KeyExtractorLeft key_extractor_left,
+               KeyExtractorRight key_extractor_right,
+               std::pmr::memory_resource* resource =
+                   std::pmr::get_default_resource()) {
+  return MakeKindJoin<JoinKind::Right>(
+      std::forward<RightRange>(right_range), std::move(key_extractor_left),
+      std::move(key_extractor_right), resource);
+}
+
+template <typename RightRange>
+auto FullJoin(RightRange&& right_range, std::pmr::memory_resource* resource =
+                                            std::pmr::get_default_resource()) {
+  return MakeKindJoin<JoinKind::Full>(std::forward<RightRange>(right_range),
+                                      resource);
+}
+
+template <typename RightRange, typename KeyExtractorLeft,
+          typename KeyExtractorRight>
+auto FullJoin(RightRange&& right_range, KeyExtractorLeft key_extractor_left,
+              KeyExtractorRight key_extractor_right,
+              std::pmr::memory_resource* resource =
+                  std::pmr::get_default_resource()) {
+  return MakeKindJoin<JoinKind::Full>(
+      std::forward<RightRange>(right_range), std::move(key_extractor_left),
+      std::move(key_extractor_right), resource);
+}
+
+template <typename LeftRange, JoinKind Kind, typename RightRange,
+          typename KeyExtractorLeft, typename KeyExtractorRight,
+          typename ValueExtractorLeft, typename ValueExtractorRight>
+auto operator|(LeftRange&& left_range,
+               const KindJoinAdapter<Kind, RightRange, KeyExtractorLeft,
+                                     KeyExtractorRight, ValueExtractorLeft,
+                                     ValueExtractorRight>& adapter) {
+  return adapter(std::forward<LeftRange>(left_range));
+}
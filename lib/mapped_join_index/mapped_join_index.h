@@ -0,0 +1,246 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "flat_hash_map/flat_hash_map.h"
+#include "join/join.h"
+#include "materialize/materialize.h"
+
+// File layout, native endianness, every section addressed by offset so the
+// file can be mapped anywhere:
+//   8-byte magic, then uint64 key_count, value_count, slot_count,
+//   key_bytes, value_bytes
+//   uint64 slots[slot_count]          group + 1, or 0 for an empty slot
+//   uint64 hashes[key_count]
+//   uint64 groups[key_count + 1]      first value of every key
+//   uint64 key_offsets[key_count + 1]
+//   uint64 value_offsets[value_count + 1]
+//   key bytes, value bytes            in Materialize encoding
+inline constexpr char kMappedJoinIndexMagic[8] = {'R', 'N', 'G', 'J',
+                                                  'I', 'X', '0', '2'};
+inline constexpr std::size_t kMappedJoinIndexFields = 5;
+
+// Built from the FlatHash primitives, which unlike std::hash do not depend
+// on the standard library build, so a file written by one process can be
+// probed by another.
+template <typename T> 
+std::uint64_t MappedJoinHash(const T& value) {
+  if constexpr (IsMaterializeString<T>::value) {
+    return FlatHashBytes(value.data(),
+                         value.size() * sizeof(typename T::value_type));
+  } else if constexpr (IsMaterializePair<T>::value) {
+    return FlatHashMix(MappedJoinHash(value.first) ^ kFlatHashSecret[2],
+                       MappedJoinHash(value.second) ^ kFlatHashSecret[3]);
+  } else if constexpr (IsMaterializeKV<T>::value) {
+    return FlatHashMix(MappedJoinHash(value.key) ^ kFlatHashSecret[2],
+                       MappedJoinHash(value.value) ^ kFlatHashSecret[3]);
+  } else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+    return FlatHash<T>{}(value);
+  } else if constexpr (std::is_floating_point_v<T>) {
+    // 0.0 and -0.0 compare equal but differ in their sign bit.
+    double normalized = value == T(0) ? 0.0 : static_cast<double>(value);
+    return FlatHashBytes(&normalized, sizeof(normalized));
+  } else {
+    static_assert(std::has_unique_object_representations_v<T>,
+                  "MappedJoinHash hashes other keys by their bytes, which "
+                  "must not include padding");
+    return FlatHashBytes(&value, sizeof(T));
+  }
+}
+
+// Values of one key inside a mapped index, decoded on access.
+template <typename Value> 
+class MappedJoinMatches {
+public:
+  MappedJoinMatches() = default;
+
+  MappedJoinMatches(const char* values, const char* values_end,
+                    const std::uint64_t* offsets, std::size_t count)
+      : values_(values), values_end_(values_end), offsets_(offsets),
+        count_(count) {}
+
+  std::size_t size() const { return count_; }
+  bool empty() const { return count_ == 0; }
+
+  Value operator[](std::size_t index) const {
+    Value value;
+    MaterializeRead(values_ + offsets_[index], values_end_, value);
+    return value;
+  }
+
+private:
+  const char* values_ = nullptr;
+  const char* values_end_ = nullptr;
+  const std::uint64_t* offsets_ = nullptr;
+  std::size_t count_ = 0;
+};
+
+// Join index opened from a file written by SaveJoinIndex. Opening only maps
+// the file; probes read the mapping directly, so processes that open the
+// same file share its page-cache copy.
+template <typename Key, typename Value> 
+class MappedJoinIndex {
+public:
+  using key_type = Key;
+  using value_type = Value;
+
+  explicit MappedJoinIndex(const std::filesystem::path& path)
+      : file_(std::make_shared<MappedFile>(path)) {
+    const char* data = file_->data();
+    std::size_t size = file_->size();
+    std::uint64_t fields[kMappedJoinIndexFields];
+    std::size_t header = sizeof(kMappedJoinIndexMagic) + sizeof(fields);
+    if (size < header ||
+        std::memcmp(data, kMappedJoinIndexMagic,
+                    sizeof(kMappedJoinIndexMagic)) != 0) {
+      throw std::runtime_error("MappedJoinIndex: bad header in " +
+                               path.string());
+    }
+    std::memcpy(fields, data + sizeof(kMappedJoinIndexMagic), sizeof(fields));
+    auto [key_count, value_count, slot_count, key_bytes, value_bytes] = fields;
+
+    std::uint64_t words = slot_count + key_count + 2 * (key_count + 1) +
+                          value_count + 1;
+    if (slot_count == 0 || (slot_count & (slot_count - 1)) != 0 ||
+        size != header + words * sizeof(std::uint64_t) + key_bytes +
+                    value_bytes) {
+      throw std::runtime_error("MappedJoinIndex: corrupt file " +
+                               path.string());
+    }
+
+    auto table = reinterpret_cast<const std::uint64_t*>(data + header);
+    slots_ = table;
+    hashes_ = slots_ + slot_count;
+    groups_ = hashes_ + key_count;
+    key_offsets_ = groups_ + key_count + 1;
+    value_offsets_ = key_offsets_ + key_count + 1;
+    keys_ = reinterpret_cast<const char*>(value_offsets_ + value_count + 1);
+    values_ = keys_ + key_bytes;
+    key_count_ = key_count;
+    value_count_ = value_count;
+    mask_ = slot_count - 1;
+  }
+
+  MappedJoinMatches<Value> Find(const Key& key) const {
+    std::uint64_t hash = MappedJoinHash(key);
+    for (std::size_t pos = hash & mask_; slots_[pos] != 0;
+         pos = (pos + 1) & mask_) {
+      std::size_t group = slots_[pos] - 1;
+      if (hashes_[group] == hash &&
+          MaterializeMatch(keys_ + key_offsets_[group],
+                           keys_ + key_offsets_[group + 1], key) != nullptr) {
+        return MappedJoinMatches<Value>(values_, values_ + valueBytes(),
+                                        value_offsets_ + groups_[group],
+                                        groups_[group + 1] - groups_[group]);
+      }
+    }
+    return {};
+  }
+
+  std::size_t KeyCount() const { return key_count_; }
+  std::size_t ValueCount() const { return value_count_; }
+
+private:
+  std::shared_ptr<MappedFile> file_;
+  const std::uint64_t* slots_ = nullptr;
+  const std::uint64_t* hashes_ = nullptr;
+  const std::uint64_t* groups_ = nullptr;
+  const std::uint64_t* key_offsets_ = nullptr;
+  const std::uint64_t* value_offsets_ = nullptr;
+  const char* keys_ = nullptr;
+  const char* values_ = nullptr;
+  std::size_t key_count_ = 0;
+  std::size_t value_count_ = 0;
+  std::size_t mask_ = 0;
+
+  std::size_t valueBytes() const { return value_offsets_[value_count_]; }
+};
+
+template <typename Key, typename Value> 
+struct IsJoinIndex<MappedJoinIndex<Key, Value>> : std::true_type {};
+
+// Writes the index to `path` through a temporary file that is renamed into
+// place, so readers never see a partially written index.
+template <typename Index>
+  requires IsJoinIndex<Index>::value
+void SaveJoinIndex(const Index& index, const std::filesystem::path& path) {
+  using Key = typename Index::key_type;
+
+  std::uint64_t key_count = index.KeyCount();
+  std::uint64_t slot_count = 1;
+  while (slot_count < 2 * key_count) {
+    slot_count *= 2;
+  }
+
+  std::vector<std::uint64_t> slots(slot_count, 0);
+  std::vector<std::uint64_t> hashes;
+  std::vector<std::uint64_t> groups = {0};
+  std::vector<std::uint64_t> key_offsets = {0};
+  std::vector<std::uint64_t> value_offsets = {0};
+  std::ostringstream keys;
+  std::ostringstream values;
+  hashes.reserve(key_count);
+
+  index.ForEachGroup([&](const Key& key, const auto& group_values) {
+    std::uint64_t hash = MappedJoinHash(key);
+    std::uint64_t pos = hash & (slot_count - 1);
+    while (slots[pos] != 0) {
+      pos = (pos + 1) & (slot_count - 1);
+    }
+    slots[pos] = hashes.size() + 1;
+    hashes.push_back(hash);
+
+    MaterializeWrite(keys, key);
+    key_offsets.push_back(static_cast<std::uint64_t>(keys.tellp()));
+    for (const auto& value : group_values) {
+      MaterializeWrite(values, value);
+      value_offsets.push_back(static_cast<std::uint64_t>(values.tellp()));
+    }
+    groups.push_back(value_offsets.size() - 1);
+  });
+
+  std::string key_bytes = std::move(keys).str();
+  std::string value_bytes = std::move(values).str();
+  std::uint64_t fields[kMappedJoinIndexFields] = {
+      key_count, value_offsets.size() - 1, slot_count, key_bytes.size(),
+      value_bytes.size()};
+
+  auto temporary = path;
+  temporary += ".tmp";
+  {
+    std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      throw std::runtime_error("SaveJoinIndex: cannot open " +
+                               temporary.string());
+    }
+    auto write_words = [&out](const std::vector<std::uint64_t>& words) {
+      out.write(reinterpret_cast<const char*>(words.data()),
+                words.size() * sizeof(std::uint64_t));
+    };
+    out.write(kMappedJoinIndexMagic, sizeof(kMappedJoinIndexMagic));
+    out.write(reinterpret_cast<const char*>(fields), sizeof(fields));
+    write_words(slots);
+    write_words(hashes);
+    write_words(groups);
+    write_words(key_offsets);
+    write_words(value_offsets);
+    out.write(key_bytes.data(), key_bytes.size());
+    out.write(value_bytes.data(), value_bytes.size());
+    if (!out) {
+      throw std::runtime_error("SaveJoinIndex: cannot write " +
+                               temporary.string());
+    }
+  }
+  std::filesystem::rename(temporary, path);
+}
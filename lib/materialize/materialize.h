@@ -0,0 +1,559 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "join/join.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// File layout: 8-byte magic, uint64 element count, then the elements one
+// after another. Trivially copyable values are stored as raw bytes, strings
+// as a varint length followed by the characters, pairs and KV field by field.
+inline constexpr char kMaterializeMagic[8] = {'R', 'N', 'G', 'M',
+                                              'A', 'T', '0', '1'};
+inline constexpr std::size_t kMaterializeHeaderSize =
+    sizeof(kMaterializeMagic) + sizeof(std::uint64_t);
+
+template <typename T>
+struct IsMaterializeString : std::false_type {};
+
+template <typename CharT, typename Traits, typename Alloc>
+struct IsMaterializeString<std::basic_string<CharT, Traits, Alloc>>
+    : std::true_type {};
+
+template <typename T>
+struct IsMaterializePair : std::false_type {};
+
+template <typename First, typename Second>
+struct IsMaterializePair<std::pair<First, Second>> : std::true_type {};
+
+template <typename T>
+struct IsMaterializeKV : std::false_type {};
+
+template <typename K, typename V>
+struct IsMaterializeKV<KV<K, V>> : std::true_type {};
+
+// Types stored as raw bytes. Pointers and string views are rejected because
+// the addresses they hold would dangle once read back; a struct holding a
+// pointer cannot be detected and must not be materialized either.
+template <typename T>
+struct IsMaterializeRaw
+    : std::bool_constant<std::is_trivially_copyable_v<T> &&
+                         !std::is_pointer_v<T> &&
+                         !std::is_member_pointer_v<T> &&
+                         !std::is_null_pointer_v<T>> {};
+
+template <typename CharT, typename Traits>
+struct IsMaterializeRaw<std::basic_string_view<CharT, Traits>>
+    : std::false_type {};
+
+inline void MaterializeWriteLength(std::ostream& out, std::uint64_t length) {
+  char buffer[10];
+  std::size_t size = 0;
+  do {
+    char byte = static_cast<char>(length & 0x7F);
+    length >>= 7;
+    if (length != 0) {
+      byte |= static_cast<char>(0x80);
+    }
+    buffer[size++] = byte;
+  } while (length != 0);
+  out.write(buffer, size);
+}
+
+inline const char* MaterializeReadLength(const char* data, const char* end,
+                                         std::uint64_t& length) {
+  length = 0;
+  for (unsigned shift = 0; shift < 64; shift += 7) {
+    if (data == end) {
+      throw std::runtime_error("Materialize: truncated length");
+    }
+    auto byte = static_cast<unsigned char>(*data++);
+    length |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return data;
+    }
+  }
+  throw std::runtime_error("Materialize: malformed length");
+}
+
+template <typename T>
+void MaterializeWrite(std::ostream& out, const T& value) {
+  if constexpr (IsMaterializeString<T>::value) {
+    MaterializeWriteLength(out, value.size());
+    out.write(reinterpret_cast<const char*>(value.data()),
+              value.size() * sizeof(typename T::value_type));
+  } else if constexpr (IsMaterializePair<T>::value) {
+    MaterializeWrite(out, value.first);
+    MaterializeWrite(out, value.second);
+  } else if constexpr (IsMaterializeKV<T>::value) {
+    MaterializeWrite(out, value.key);
+    MaterializeWrite(out, value.value);
+  } else {
+    static_assert(IsMaterializeRaw<T>::value,
+                  "Materialize supports trivially copyable types without "
+                  "pointers, strings, std::pair and KV");
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+}
+
+template <typename T>
+const char* MaterializeRead(const char* data, const char* end, T& value) {
+  if constexpr (IsMaterializeString<T>::value) {
+    using CharT = typename T::value_type;
+    std::uint64_t length = 0;
+    data = MaterializeReadLength(data, end, length);
+    if (static_cast<std::uint64_t>(end - data) / sizeof(CharT) < length) {
+      throw std::runtime_error("Materialize: truncated string");
+    }
+    value.resize(length);
+    std::memcpy(value.data(), data, length * sizeof(CharT));
+    return data + length * sizeof(CharT);
+  } else if constexpr (IsMaterializePair<T>::value) {
+    data = MaterializeRead(data, end, value.first);
+    return MaterializeRead(data, end, value.second);
+  } else if constexpr (IsMaterializeKV<T>::value) {
+    data = MaterializeRead(data, end, value.key);
+    return MaterializeRead(data, end, value.value);
+  } else {
+    static_assert(IsMaterializeRaw<T>::value,
+                  "Materialize supports trivially copyable types without "
+                  "pointers, strings, std::pair and KV");
+    if (static_cast<std::size_t>(end - data) < sizeof(T)) {
+      throw std::runtime_error("Materialize: truncated value");
+    }
+    std::memcpy(&value, data, sizeof(T));
+    return data + sizeof(T);
+  }
+}
+
+// Compares a stored value with `value` without decoding it. Returns the
+// position after the stored value when they are equal, nullptr otherwise.
+template <typename T>
+const char* MaterializeMatch(const char* data, const char* end,
+                             const T& value) {
+  if constexpr (IsMaterializeString<T>::value) {
+    using CharT = typename T::value_type;
+    std::uint64_t length = 0;
+    data = MaterializeReadLength(data, end, length);
+    if (length != value.size() ||
+        static_cast<std::uint64_t>(end - data) / sizeof(CharT) < length ||
+        std::memcmp(data, value.data(), length * sizeof(CharT)) != 0) {
+      return nullptr;
+    }
+    return data + length * sizeof(CharT);
+  } else if constexpr (IsMaterializePair<T>::value) {
+    data = MaterializeMatch(data, end, value.first);
+    return data == nullptr ? nullptr : MaterializeMatch(data, end, value.second);
+  } else if constexpr (IsMaterializeKV<T>::value) {
+    data = MaterializeMatch(data, end, value.key);
+    return data == nullptr ? nullptr : MaterializeMatch(data, end, value.value);
+  } else {
+    T stored;
+    data = MaterializeRead(data, end, stored);
+    return stored == value ? data : nullptr;
+  }
+}
+
+// Limits how much of a build side an operator keeps in memory before it
+// starts spilling partitions into files under spill_directory.
+struct MemoryBudget {
+  std::size_t bytes;
+  std::size_t partitions = 16;
+  std::filesystem::path spill_directory = std::filesystem::temp_directory_path();
+};
+
+// Unique directory for one operator's spill files, removed with its
+// contents.
+class SpillDirectory {
+public:
+  explicit SpillDirectory(const std::filesystem::path& parent) {
+    static std::atomic<std::uint64_t> counter = 0;
+    path_ = parent / ("ranges_spill_" + std::to_string(std::random_device{}()) +
+                      "_" + std::to_string(counter++));
+    std::filesystem::create_directories(path_);
+  }
+
+  SpillDirectory(const SpillDirectory&) = delete;
+  SpillDirectory& operator=(const SpillDirectory&) = delete;
+
+  ~SpillDirectory() {
+    std::error_code error;
+    std::filesystem::remove_all(path_, error);
+  }
+
+  std::filesystem::path File(const std::string& side, std::size_t index) const {
+    return path_ / (side + "-" + std::to_string(index) + ".bin");
+  }
+
+private:
+  std::filesystem::path path_;
+};
+
+// Approximate in-memory footprint of a value: its own size plus the heap
+// storage of any strings it holds.
+template <typename T>
+std::size_t EstimateMemoryUsage(const T& value) {
+  if constexpr (IsMaterializeString<T>::value) {
+    return sizeof(T) + value.capacity() * sizeof(typename T::value_type);
+  } else if constexpr (IsMaterializePair<T>::value) {
+    return EstimateMemoryUsage(value.first) + EstimateMemoryUsage(value.second);
+  } else if constexpr (IsMaterializeKV<T>::value) {
+    return EstimateMemoryUsage(value.key) + EstimateMemoryUsage(value.value);
+  } else {
+    return sizeof(T);
+  }
+}
+
+class MappedFile {
+public:
+  explicit MappedFile(const std::filesystem::path& path) {
+#if defined(_WIN32)
+    file_ = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+      throw std::runtime_error("MappedFile: cannot open " + path.string());
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(file_, &size);
+    size_ = static_cast<std::size_t>(size.QuadPart);
+    if (size_ != 0) {
+      mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (mapping_ == nullptr) {
+        CloseHandle(file_);
+        throw std::runtime_error("MappedFile: cannot map " + path.string());
+      }
+      data_ = static_cast<const char*>(
+          MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("MappedFile: cannot open " + path.string());
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+      ::close(fd);
+      throw std::runtime_error("MappedFile: cannot stat " + path.string());
+    }
+    size_ = static_cast<std::size_t>(info.st_size);
+    if (size_ != 0) {
+      void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("MappedFile: cannot map " + path.string());
+      }
+      ::madvise(data, size_, MADV_SEQUENTIAL);
+      data_ = static_cast<const char*>(data);
+    }
+    ::close(fd);
+#endif
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ~MappedFile() {
+#if defined(_WIN32)
+    if (data_ != nullptr) {
+      UnmapViewOfFile(data_);
+    }
+    if (mapping_ != nullptr) {
+      CloseHandle(mapping_);
+    }
+    CloseHandle(file_);
+#else
+    if (data_ != nullptr) {
+      ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+  }
+
+  const char* data() const { return data_; }
+  std::size_t size() const { return size_; }
+
+private:
+  const char* data_ = nullptr;
+  std::size_t size_ = 0;
+#if defined(_WIN32)
+  HANDLE file_ = INVALID_HANDLE_VALUE;
+  HANDLE mapping_ = nullptr;
+#endif
+};
+
+template <typename T>
+class MaterializedIterator {
+public:
+  using iterator_category = std::input_iterator_tag;
+  using value_type = T;
+  using difference_type = std::ptrdiff_t;
+  using pointer = value_type*;
+  using reference = value_type&;
+
+  MaterializedIterator(const char* current, const char* end)
+      : current_(current), next_(current), end_(end) {
+    if (current_ != end_) {
+      readCurrent();
+    }
+  }
+
+  reference operator*() const { return value_; }
+
+  pointer operator->() const { return &value_; }
+
+  MaterializedIterator& operator++() {
+    current_ = next_;
+    if (current_ != end_) {
+      readCurrent();
+    }
+    return *this;
+  }
+
+  bool operator!=(const MaterializedIterator& other) const {
+    return current_ != other.current_;
+  }
+
+private:
+  const char* current_;
+  const char* next_;
+  const char* end_;
+  mutable value_type value_;
+
+  void readCurrent() { next_ = MaterializeRead(current_, end_, value_); }
+};
+
+template <typename T>
+class MaterializedRange {
+public:
+  using value_type = T;
+  using iterator = MaterializedIterator<T>;
+  using const_iterator = MaterializedIterator<T>;
+
+  explicit MaterializedRange(const std::filesystem::path& path)
+      : path_(path), file_(std::make_shared<MappedFile>(path)) {
+    if (file_->size() < kMaterializeHeaderSize ||
+        std::memcmp(file_->data(), kMaterializeMagic,
+                    sizeof(kMaterializeMagic)) != 0) {
+      throw std::runtime_error("Materialize: bad header in " + path.string());
+    }
+    std::memcpy(&size_, file_->data() + sizeof(kMaterializeMagic),
+                sizeof(size_));
+  }
+
+  iterator begin() const {
+    return iterator(file_->data() + kMaterializeHeaderSize,
+                    file_->data() + file_->size());
+  }
+
+  iterator end() const {
+    return iterator(file_->data() + file_->size(),
+                    file_->data() + file_->size());
+  }
+
+  std::size_t size() const { return static_cast<std::size_t>(size_); }
+
+  const std::filesystem::path& path() const { return path_; }
+
+private:
+  std::filesystem::path path_;
+  std::shared_ptr<MappedFile> file_;
+  std::uint64_t size_ = 0;
+};
+
+// Streams values into a materialized file through its own write buffer and
+// patches the element count into the header on Finish().
+template <typename T>
+class MaterializeWriter {
+public:
+  static constexpr std::size_t kBufferSize = 64 * 1024;
+
+  explicit MaterializeWriter(std::filesystem::path path)
+      : path_(std::move(path)), buffer_(std::make_unique<char[]>(kBufferSize)) {
+    out_.rdbuf()->pubsetbuf(buffer_.get(), kBufferSize);
+    out_.open(path_, std::ios::binary | std::ios::trunc);
+    if (!out_) {
+      throw std::runtime_error("Materialize: cannot open " + path_.string());
+    }
+    out_.write(kMaterializeMagic, sizeof(kMaterializeMagic));
+    out_.write(reinterpret_cast<const char*>(&count_), sizeof(count_));
+  }
+
+  void Write(const T& value) {
+    MaterializeWrite<T>(out_, value);
+    ++count_;
+  }
+
+  MaterializedRange<T> Finish() {
+    out_.seekp(sizeof(kMaterializeMagic));
+    out_.write(reinterpret_cast<const char*>(&count_), sizeof(count_));
+    out_.close();
+    if (!out_) {
+      throw std::runtime_error("Materialize: cannot write " + path_.string());
+    }
+    return MaterializedRange<T>(path_);
+  }
+
+private:
+  std::filesystem::path path_;
+  std::unique_ptr<char[]> buffer_;
+  std::ofstream out_;
+  std::uint64_t count_ = 0;
+};
+
+inline constexpr std::size_t kMaterializeMergeFanIn = 64;
+
+// K-way merge over runs that are each sorted by `less`. top() is the
+// smallest current value, ties going to the earlier run, and may be moved
+// from before pop(). The runs must outlive the merge.
+template <typename T, typename Less>
+class MaterializedMerge {
+public:
+  MaterializedMerge(const std::vector<MaterializedRange<T>>& runs, Less less)
+      : less_(std::move(less)) {
+    for (const auto& run : runs) {
+      if (run.begin() != run.end()) {
+        heap_.push_back(cursors_.size());
+        cursors_.emplace_back(run.begin(), run.end());
+      }
+    }
+    std::make_heap(heap_.begin(), heap_.end(), later());
+  }
+
+  bool empty() const { return heap_.empty(); }
+
+  T& top() const { return *cursors_[heap_.front()].first; }
+
+  void pop() {
+    std::pop_heap(heap_.begin(), heap_.end(), later());
+    auto& [current, end] = cursors_[heap_.back()];
+    ++current;
+    if (current != end) {
+      std::push_heap(heap_.begin(), heap_.end(), later());
+    } else {
+      heap_.pop_back();
+    }
+  }
+
+private:
+  Less less_;
+  std::vector<std::pair<MaterializedIterator<T>, MaterializedIterator<T>>>
+      cursors_;
+  std::vector<std::size_t> heap_;
+
+  auto later() const {
+    return [this](std::size_t lhs, std::size_t rhs) {
+      const T& left = *cursors_[lhs].first;
+      const T& right = *cursors_[rhs].first;
+      if (less_(right, left)) {
+        return true;
+      }
+      return !less_(left, right) && lhs > rhs;
+    };
+  }
+};
+
+// Merges sorted spill runs in passes of at most fan_in runs until no more
+// than fan_in remain, so a final merge never maps more files than that.
+// Merged runs are written to `spill` under `name` and the consumed run
+// files are deleted.
+template <typename T, typename Less>
+std::vector<MaterializedRange<T>>
+ReduceRuns(std::vector<MaterializedRange<T>> runs, const Less& less,
+           const SpillDirectory& spill, const std::string& name,
+           std::size_t fan_in = kMaterializeMergeFanIn) {
+  fan_in = std::max<std::size_t>(fan_in, 2);
+  std::size_t written = 0;
+  while (runs.size() > fan_in) {
+    std::vector<MaterializedRange<T>> merged;
+    for (std::size_t first = 0; first < runs.size(); first += fan_in) {
+      std::size_t last = std::min(first + fan_in, runs.size());
+      if (last - first == 1) {
+        merged.push_back(std::move(runs[first]));
+        continue;
+      }
+      std::vector<std::filesystem::path> consumed;
+      {
+        std::vector<MaterializedRange<T>> group(
+            std::make_move_iterator(runs.begin() + first),
+            std::make_move_iterator(runs.begin() + last));
+        MaterializeWriter<T> writer(spill.File(name, written++));
+        for (MaterializedMerge<T, Less> merge(group, less); !merge.empty();
+             merge.pop()) {
+          writer.Write(merge.top());
+        }
+        merged.push_back(writer.Finish());
+        for (const auto& run : group) {
+          consumed.push_back(run.path());
+        }
+      }
+      for (const auto& path : consumed) {
+        std::error_code error;
+        std::filesystem::remove(path, error);
+      }
+    }
+    runs = std::move(merged);
+  }
+  return runs;
+}
+
+class MaterializeOperation {
+public:
+  explicit MaterializeOperation(std::filesystem::path path)
+      : path_(std::move(path)) {}
+
+  template <typename Range>
+  auto operator|(Range&& range) const {
+    using value_type = typename std::decay_t<Range>::value_type;
+
+    MaterializeWriter<value_type> writer(path_);
+    for (const auto& item : range) {
+      writer.Write(item);
+    }
+    return writer.Finish();
+  }
+
+private:
+  std::filesystem::path path_;
+};
+
+inline auto Materialize(const std::filesystem::path& path) {
+  return MaterializeOperation(path);
+}
+
+template <typename T>
+auto FromMaterialized(const std::filesystem::path& path) {
+  return MaterializedRange<T>(path);
+}
+
+template <typename Range>
+auto operator|(Range&& range, const MaterializeOperation& op) {
+  return op.operator|(std::forward<Range>(range));
+}
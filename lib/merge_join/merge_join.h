@@ -0,0 +1,236 @@
+#pragma once
+
+#include <cassert>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "join/join.h"
+
+// Left join of two ranges that are both sorted by key. The inputs are
+// walked together and only the right-side group for the current key is
+// buffered, so memory does not depend on the size of either input.
+template <typename LeftRange, typename RightRange, typename KeyExtractorLeft,
+          typename KeyExtractorRight, typename ValueExtractorLeft,
+          typename ValueExtractorRight>
+class MergeJoinIterator {
+public:
+  using key_type = std::decay_t<decltype(std::declval<KeyExtractorLeft>()(
+      *std::declval<typename LeftRange::iterator>()))>;
+
+  using left_value_type =
+      std::decay_t<decltype(std::declval<ValueExtractorLeft>()(
+          *std::declval<typename LeftRange::iterator>()))>;
+
+  using right_value_type =
+      std::decay_t<decltype(std::declval<ValueExtractorRight>()(
+          *std::declval<typename RightRange::iterator>()))>;
+
+  using iterator_category = std::input_iterator_tag;
+  using value_type = JoinResult<left_value_type, right_value_type>;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const value_type *;
+  using reference = const value_type &;
+
+  MergeJoinIterator(typename LeftRange::iterator left_it,
+                    typename LeftRange::iterator left_end,
+                    typename RightRange::iterator right_it,
+                    typename RightRange::iterator right_end,
+                    KeyExtractorLeft key_extractor_left,
+                    KeyExtractorRight key_extractor_right,
+                    ValueExtractorLeft value_extractor_left,
+                    ValueExtractorRight value_extractor_right)
+      : left_it_(left_it), left_end_(left_end), right_it_(right_it),
+        right_end_(right_end), key_extractor_left_(key_extractor_left),
+        key_extractor_right_(key_extractor_right),
+        value_extractor_left_(value_extractor_left),
+        value_extractor_right_(value_extractor_right) {
+    if (left_it_ != left_end_) {
+      updateRightValues();
+    }
+  }
+
+  reference operator*() const { return current_; }
+
+  MergeJoinIterator &operator++() {
+    if (right_index_pos_ + 1 < group_.size()) {
+      ++right_index_pos_;
+      current_.right = group_[right_index_pos_];
+    } else {
+      ++left_it_;
+      right_index_pos_ = 0;
+      if (left_it_ != left_end_) {
+        updateRightValues();
+      }
+    }
+    return *this;
+  }
+
+  bool operator!=(const MergeJoinIterator &other) const {
+    return left_it_ != other.left_it_ ||
+           (left_it_ != left_end_ && other.left_it_ != other.left_end_ &&
+            right_index_pos_ != other.right_index_pos_);
+  }
+
+private:
+  typename LeftRange::iterator left_it_;
+  typename LeftRange::iterator left_end_;
+  typename RightRange::iterator right_it_;
+  typename RightRange::iterator right_end_;
+  KeyExtractorLeft key_extractor_left_;
+  KeyExtractorRight key_extractor_right_;
+  ValueExtractorLeft value_extractor_left_;
+  ValueExtractorRight value_extractor_right_;
+  std::optional<key_type> group_key_;
+  std::vector<right_value_type> group_;
+  size_t right_index_pos_ = 0;
+  value_type current_;
+#ifndef NDEBUG
+  std::optional<key_type> last_right_key_;
+#endif
+
+  void updateRightValues() {
+    auto key = key_extractor_left_(*left_it_);
+    assert((!group_key_ || !(key < *group_key_)) &&
+           "MergeJoin: left input is not sorted by key");
+
+    if (!group_key_ || !(*group_key_ == key)) {
+      group_.clear();
+      while (right_it_ != right_end_ && key_extractor_right_(*right_it_) < key) {
+        advanceRight();
+      }
+      while (right_it_ != right_end_ && key_extractor_right_(*right_it_) == key) {
+        group_.push_back(value_extractor_right_(*right_it_));
+        advanceRight();
+      }
+      group_key_ = std::move(key);
+    }
+
+    if (!group_.empty()) {
+      current_ = value_type{value_extractor_left_(*left_it_), group_.front()};
+    } else {
+      current_ = value_type{value_extractor_left_(*left_it_), std::nullopt};
+    }
+  }
+
+  void advanceRight() {
+#ifndef NDEBUG
+    key_type right_key = key_extractor_right_(*right_it_);
+    assert((!last_right_key_ || !(right_key < *last_right_key_)) &&
+           "MergeJoin: right input is not sorted by key");
+    last_right_key_ = std::move(right_key);
+#endif
+    ++right_it_;
+  }
+};
+
+template <typename LeftRange, typename RightRange, typename KeyExtractorLeft,
+          typename KeyExtractorRight, typename ValueExtractorLeft,
+          typename ValueExtractorRight>
+class MergeJoinRange {
+public:
+  using iterator =
+      MergeJoinIterator<LeftRange, RightRange, KeyExtractorLeft,
+                        KeyExtractorRight, ValueExtractorLeft,
+                        ValueExtractorRight>;
+  using value_type = typename iterator::value_type;
+
+  MergeJoinRange(LeftRange left_range, RightRange right_range,
+                 KeyExtractorLeft key_extractor_left,
+                 KeyExtractorRight key_extractor_right,
+                 ValueExtractorLeft value_extractor_left,
+                 ValueExtractorRight value_extractor_right)
+      : left_range_(std::move(left_range)),
+        right_range_(std::move(right_range)),
+        key_extractor_left_(std::move(key_extractor_left)),
+        key_extractor_right_(std::move(key_extractor_right)),
+        value_extractor_left_(std::move(value_extractor_left)),
+        value_extractor_right_(std::move(value_extractor_right)) {}
+
+  iterator begin() {
+    return iterator(left_range_.begin(), left_range_.end(),
+                    right_range_.begin(), right_range_.end(),
+                    key_extractor_left_, key_extractor_right_,
+                    value_extractor_left_, value_extractor_right_);
+  }
+
+  iterator end() {
+    return iterator(left_range_.end(), left_range_.end(), right_range_.end(),
+                    right_range_.end(), key_extractor_left_,
+                    key_extractor_right_, value_extractor_left_,
+                    value_extractor_right_);
+  }
+
+private:
+  LeftRange left_range_;
+  RightRange right_range_;
+  KeyExtractorLeft key_extractor_left_;
+  KeyExtractorRight key_extractor_right_;
+  ValueExtractorLeft value_extractor_left_;
+  ValueExtractorRight value_extractor_right_;
+};
+
+template <typename RightRange, typename KeyExtractorLeft,
+          typename KeyExtractorRight, typename ValueExtractorLeft,
+          typename ValueExtractorRight>
+class MergeJoinAdapter {
+public:
+  MergeJoinAdapter(RightRange right_range, KeyExtractorLeft key_extractor_left,
+                   KeyExtractorRight key_extractor_right,
+                   ValueExtractorLeft value_extractor_left,
+                   ValueExtractorRight value_extractor_right)
+      : right_range_(std::move(right_range)),
+        key_extractor_left_(std::move(key_extractor_left)),
+        key_extractor_right_(std::move(key_extractor_right)),
+        value_extractor_left_(std::move(value_extractor_left)),
+        value_extractor_right_(std::move(value_extractor_right)) {}
+
+  template <typename LeftRange> auto operator()(LeftRange&& left_range) const {
+    return MergeJoinRange<std::decay_t<LeftRange>, RightRange, KeyExtractorLeft,
+                          KeyExtractorRight, ValueExtractorLeft,
+                          ValueExtractorRight>(
+        std::forward<LeftRange>(left_range), right_range_, key_extractor_left_,
+        key_extractor_right_, value_extractor_left_, value_extractor_right_);
+  }
+
+private:
+  RightRange right_range_;
+  KeyExtractorLeft key_extractor_left_;
+  KeyExtractorRight key_extractor_right_;
+  ValueExtractorLeft value_extractor_left_;
+  ValueExtractorRight value_extractor_right_;
+};
+
+template <typename RightRange> auto MergeJoin(RightRange&& right_range) {
+  using Element = typename std::decay_t<RightRange>::value_type;
+  return MergeJoinAdapter<std::decay_t<RightRange>, KeyExtractor<Element>,
+                          KeyExtractor<Element>, ValueExtractor<Element>,
+                          ValueExtractor<Element>>(
+      std::forward<RightRange>(right_range), KeyExtractor<Element>{},
+      KeyExtractor<Element>{}, ValueExtractor<Element>{},
+      ValueExtractor<Element>{});
+}
+
+template <typename RightRange, typename KeyExtractorLeft,
+          typename KeyExtractorRight>
+auto MergeJoin(RightRange&& right_range, KeyExtractorLeft key_extractor_left,
+               KeyExtractorRight key_extractor_right) {
+  using Element = typename std::decay_t<RightRange>::value_type;
+  return MergeJoinAdapter<std::decay_t<RightRange>, KeyExtractorLeft,
+                          KeyExtractorRight, IdentityExtractor<Element>,
+                          IdentityExtractor<Element>>(
+      std::forward<RightRange>(right_range), std::move(key_extractor_left),
+      std::move(key_extractor_right), IdentityExtractor<Element>{},
+      IdentityExtractor<Element>{});
+}
+
+template <typename LeftRange, typename RightRange, typename KeyExtractorLeft,
+          typename KeyExtractorRight, typename ValueExtractorLeft,
+          typename ValueExtractorRight>
+auto operator|(LeftRange&& left_range,
+               const MergeJoinAdapter<RightRange, KeyExtractorLeft,
+                                      KeyExtractorRight, ValueExtractorLeft,
+                                      ValueExtractorRight>& adapter) {
+  return adapter(std::forward<LeftRange>(left_range));
+}
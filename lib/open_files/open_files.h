@@ -3,9 +3,12 @@
 #include <fstream>
 #include <iterator>
 #include <memory>
+#include <optional>
 #include <type_traits>
 #include <utility>
 
+#include "size_hint/size_hint.h"
+
 
 template <typename Iterator> 
 class OpenFilesIterator {
@@ -74,6 +77,10 @@ public:
     return const_iterator(range_.end(), range_.end());
   }
 
+  std::optional<SizeHint> size_hint() const {
+    return AsUpperBound(GetSizeHint(range_));
+  }
+
 private:
   Range range_;
 };
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "aggregate_by_key/aggregate_by_key.h"
+#include "channel/channel.h"
+#include "flat_hash_map/flat_hash_map.h"
+#include "thread_pool/thread_pool.h"
+
+// AggregateByKey spread over a thread pool. The input is cut into batches
+// that are dealt round-robin to one worker per thread, each aggregating
+// into its own table. Every worker then splits its table by key hash, and
+// each hash partition is merged with the combiner and sorted by first
+// appearance on its own thread. Only the final k-way merge of the sorted
+// partitions into the result runs on the calling thread. Groups are
+// returned in the order their keys first appear in the input, as
+// AggregateByKey does.
+//
+// combiner(accumulated, other) folds the partial result `other` into
+// `accumulated`; it gets the partials of one key in no particular order.
+template <typename InitialValue, typename AggregateFunc,
+          typename KeyExtractorFunc, typename CombineFunc>
+class ParallelAggregateByKeyRange {
+public:
+  static constexpr std::size_t kBatchSize = 4096;
+
+  ParallelAggregateByKeyRange(InitialValue initialValue,
+                              AggregateFunc aggregator,
+                              KeyExtractorFunc keyExtractor,
+                              CombineFunc combiner, std::size_t threads)
+      : initialValue_(std::move(initialValue)),
+        aggregator_(std::move(aggregator)),
+        keyExtractor_(std::move(keyExtractor)), combiner_(std::move(combiner)),
+        threads_(std::max<std::size_t>(threads, 1)) {}
+
+  template <typename Range> 
+  auto operator|(Range&& range) const {
+    using Element = typename std::decay_t<Range>::value_type;
+    using Key = typename AggregateStoredKey<std::decay_t<
+        decltype(keyExtractor_(std::declval<const Element&>()))>>::type;
+    using AccumulatedValue = InitialValue;
+
+    struct Group {
+      std::size_t first_seen;
+      AccumulatedValue value;
+    };
+    using Entry = std::pair<Key, Group>;
+    using Batch = std::pair<std::size_t, std::vector<Element>>;
+
+    std::vector<std::unique_ptr<Channel<Batch>>> lanes;
+    for (std::size_t lane = 0; lane < threads_; ++lane) {
+      lanes.push_back(std::make_unique<Channel<Batch>>(2));
+    }
+    std::vector<std::vector<std::vector<Entry>>> partitions(
+        threads_, std::vector<std::vector<Entry>>(threads_));
+
+    ThreadPool pool(threads_);
+
+    std::vector<std::future<void>> workers;
+    for (std::size_t lane = 0; lane < threads_; ++lane) {
+      workers.push_back(pool.Submit([&, lane] {
+        try {
+          FlatHashMap<Key, Group> table;
+          Batch batch;
+          while (lanes[lane]->Pop(batch)) {
+            for (std::size_t i = 0; i < batch.second.size(); ++i) {
+              const auto& element = batch.second[i];
+              decltype(auto) key = keyExtractor_(element);
+              auto [it, inserted] =
+                  table.try_emplace(std::forward<decltype(key)>(key),
+                                    batch.first + i, initialValue_);
+              aggregator_(element, it->second.value);
+            }
+          }
+          for (auto& entry : table.release()) {
+            partitions[lane][partitionOf(entry.first)].push_back(
+                std::move(entry));
+          }
+        } catch (...) {
+          lanes[lane]->Close();
+          throw;
+        }
+      }));
+    }
+
+    try {
+      std::vector<Element> batch;
+      std::size_t position = 0;
+      std::size_t lane = 0;
+      auto flush = [&] {
+        if (batch.empty()) {
+          return true;
+        }
+        std::size_t start = position - batch.size();
+        bool pushed = lanes[lane]->Push(Batch{start, std::move(batch)});
+        batch = std::vector<Element>();
+        batch.reserve(kBatchSize);
+        lane = (lane + 1) % threads_;
+        return pushed;
+      };
+
+      batch.reserve(kBatchSize);
+      for (const auto& element : range) {
+        batch.push_back(element);
+        ++position;
+        if (batch.size() == kBatchSize && !flush()) {
+          break;
+        }
+      }
+      flush();
+    } catch (...) {
+      closeAll(lanes);
+      throw;
+    }
+    closeAll(lanes);
+    for (auto& worker : workers) {
+      worker.get();
+    }
+
+    std::vector<std::future<std::vector<Entry>>> merges;
+    for (std::size_t partition = 0; partition < threads_; ++partition) {
+      merges.push_back(pool.Submit([&, partition] {
+        FlatHashMap<Key, Group> merged;
+        for (auto& lane : partitions) {
+          for (auto& [key, group] : lane[partition]) {
+            auto [it, inserted] = merged.try_emplace(std::move(key), std::move(group));
+            if (!inserted) {
+              it->second.first_seen =
+                  std::min(it->second.first_seen, group.first_seen);
+              combiner_(it->second.value, std::move(group.value));
+            }
+          }
+          lane[partition].clear();
+        }
+        auto entries = merged.release();
+        std::vector<Entry> part(std::make_move_iterator(entries.begin()),
+                                std::make_move_iterator(entries.end()));
+        std::sort(part.begin(), part.end(),
+                  [](const Entry& lhs, const Entry& rhs) {
+                    return lhs.second.first_seen < rhs.second.first_seen;
+                  });
+        return part;
+      }));
+    }
+
+    std::vector<std::vector<Entry>> parts;
+    std::size_t total = 0;
+    for (auto& merge : merges) {
+      parts.push_back(merge.get());
+      total += parts.back().size();
+    }
+
+    // Each part is already in first-seen order; a heap over the parts'
+    // heads interleaves them, so the caller only does an O(K log threads)
+    // merge while moving groups into the result.
+    std::vector<std::size_t> heads(parts.size(), 0);
+    auto later = [&](std::size_t lhs, std::size_t rhs) {
+      return parts[lhs][heads[lhs]].second.first_seen >
+             parts[rhs][heads[rhs]].second.first_seen;
+    };
+    std::vector<std::size_t> heap;
+    for (std::size_t part = 0; part < parts.size(); ++part) {
+      if (!parts[part].empty()) {
+        heap.push_back(part);
+      }
+    }
+    std::make_heap(heap.begin(), heap.end(), later);
+
+    std::vector<std::pair<Key, AccumulatedValue>> result;
+    result.reserve(total);
+    while (!heap.empty()) {
+      std::pop_heap(heap.begin(), heap.end(), later);
+      std::size_t part = heap.back();
+      auto& [key, group] = parts[part][heads[part]];
+      result.emplace_back(std::move(key), std::move(group.value));
+      if (++heads[part] < parts[part].size()) {
+        std::push_heap(heap.begin(), heap.end(), later);
+      } else {
+        heap.pop_back();
+      }
+    }
+    return result;
+  }
+
+private:
+  InitialValue initialValue_;
+  AggregateFunc aggregator_;
+  KeyExtractorFunc keyExtractor_;
+  CombineFunc combiner_;
+  std::size_t threads_;
+
+  template <typename Key> 
+  std::size_t partitionOf(const Key& key) const {
+    // Tables probe with the low hash bits, so partitions use the high ones.
+    std::uint64_t hash = FlatHash<Key>{}(key);
+    return static_cast<std::size_t>(((hash * 0x9E3779B97F4A7C15ull) >> 32) %
+                                    threads_);
+  }
+
+  template <typename Lanes> 
+  static void closeAll(Lanes& lanes) {
+    for (auto& lane : lanes) {
+      lane->Close();
+    }
+  }
+};
+
+template <typename InitialValue, typename AggregateFunc,
+          typename KeyExtractorFunc, typename CombineFunc>
+auto ParallelAggregateByKey(InitialValue initialValue, AggregateFunc aggregator,
+                            KeyExtractorFunc keyExtractor, CombineFunc combiner,
+                            std::size_t threads = ThreadPool::DefaultThreads()) {
+  return ParallelAggregateByKeyRange<InitialValue, AggregateFunc,
+                                     KeyExtractorFunc, CombineFunc>(
+      std::move(initialValue), std::move(aggregator), std::move(keyExtractor),
+      std::move(combiner), threads);
+}
+
+template <typename Range, typename InitialValue, typename AggregateFunc,
+          typename KeyExtractorFunc, typename CombineFunc>
+auto operator|(Range&& range,
+               const ParallelAggregateByKeyRange<InitialValue, AggregateFunc,
+                                                 KeyExtractorFunc, CombineFunc>&
+                   operation) {
+  return operation.operator|(std::forward<Range>(range));
+}
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "from_generator/from_generator.h"
+#include "join/join.h"
+#include "thread_pool/thread_pool.h"
+
+// Runs Join on a thread pool. With ordered = false batches are emitted as
+// soon as they are probed, which keeps every worker busy but gives up the
+// left-row order of the output.
+struct JoinParallelism {
+  std::size_t threads = ThreadPool::DefaultThreads();
+  bool ordered = true;
+  std::size_t batch_size = 4096;
+};
+
+// The right side is read in batches that workers radix-partition by key
+// hash into batch-local partitions, one per thread. Every partition's
+// FlatJoinIndex is then built on its own worker from its pieces of all the
+// batches, in input order. Left rows are read in batches too and each
+// batch is probed as a separate task; both phases keep at most two batches
+// per thread in flight.
+template <typename LeftRange, typename RightRange, typename KeyExtractorLeft,
+          typename KeyExtractorRight, typename ValueExtractorLeft,
+          typename ValueExtractorRight,
+          typename Iterator = JoinIterator<LeftRange, RightRange,
+                                           KeyExtractorLeft, KeyExtractorRight,
+                                           ValueExtractorLeft, ValueExtractorRight>>
+Generator<typename Iterator::value_type>
+ParallelJoin(LeftRange left_range, RightRange right_range,
+             KeyExtractorLeft key_extractor_left,
+             KeyExtractorRight key_extractor_right,
+             ValueExtractorLeft value_extractor_left,
+             ValueExtractorRight value_extractor_right,
+             JoinParallelism parallelism) {
+  using key_type = typename Iterator::key_type;
+  using right_value_type = typename Iterator::right_value_type;
+  using value_type = typename Iterator::value_type;
+  using left_item = std::decay_t<decltype(*left_range.begin())>;
+  using right_item = std::decay_t<decltype(*right_range.begin())>;
+  using right_entry = KV<key_type, right_value_type>;
+  using batch_result = std::vector<value_type>;
+  using scattered_batch = std::vector<std::vector<right_entry>>;
+
+  std::size_t partitions = std::max<std::size_t>(parallelism.threads, 1);
+  std::size_t batch_size = std::max<std::size_t>(parallelism.batch_size, 1);
+
+  // pieces[p] holds partition p of every right batch, in input order.
+  std::vector<std::vector<std::vector<right_entry>>> pieces(partitions);
+  std::vector<FlatJoinIndex<key_type, right_value_type>> indexes(partitions);
+
+  auto scatter = [&](const std::vector<right_item>& batch) {
+    scattered_batch local(partitions);
+    for (const auto& item : batch) {
+      key_type key(key_extractor_right(item));
+      auto& partition = local[JoinPartition(key, partitions)];
+      partition.push_back({std::move(key), value_extractor_right(item)});
+    }
+    return local;
+  };
+
+  auto probe = [&](const std::vector<left_item>& batch) {
+    batch_result rows;
+    rows.reserve(batch.size());
+    for (const auto& item : batch) {
+      auto key = key_extractor_left(item);
+      auto matches = indexes[JoinPartition(key, partitions)].Find(key);
+      if (matches.empty()) {
+        rows.push_back(value_type{value_extractor_left(item), std::nullopt});
+      }
+      for (const auto& match : matches) {
+        rows.push_back(value_type{value_extractor_left(item), match});
+      }
+    }
+    return rows;
+  };
+
+  // Declared after everything the tasks touch, so that an abandoned join
+  // drains its queued tasks before their state goes away.
+  ThreadPool pool(partitions);
+  std::size_t window = 2 * pool.size();
+
+  {
+    std::deque<std::future<scattered_batch>> scattering;
+    auto collect = [&] {
+      scattered_batch local = scattering.front().get();
+      scattering.pop_front();
+      for (std::size_t i = 0; i < partitions; ++i) {
+        pieces[i].push_back(std::move(local[i]));
+      }
+    };
+
+    auto right_it = right_range.begin();
+    auto right_end = right_range.end();
+    while (right_it != right_end) {
+      std::vector<right_item> batch;
+      batch.reserve(batch_size);
+      for (; right_it != right_end && batch.size() < batch_size; ++right_it) {
+        batch.push_back(*right_it);
+      }
+      if (scattering.size() == window) {
+        collect();
+      }
+      scattering.push_back(pool.Submit(
+          [&scatter, batch = std::move(batch)] { return scatter(batch); }));
+    }
+    while (!scattering.empty()) {
+      collect();
+    }
+  }
+
+  {
+    std::vector<std::future<void>> builds;
+    for (std::size_t i = 0; i < partitions; ++i) {
+      builds.push_back(pool.Submit([&pieces, &indexes, i] {
+        for (auto& piece : pieces[i]) {
+          for (auto& entry : piece) {
+            indexes[i].Add(std::move(entry.key), std::move(entry.value));
+          }
+          piece = {};
+        }
+        pieces[i] = {};
+        indexes[i].Build();
+      }));
+    }
+    for (auto& build : builds) {
+      build.get();
+    }
+  }
+
+  std::deque<std::future<batch_result>> in_flight;
+  auto left_it = left_range.begin();
+  auto left_end = left_range.end();
+
+  while (true) {
+    while (in_flight.size() < window && left_it != left_end) {
+      std::vector<left_item> batch;
+      batch.reserve(batch_size);
+      for (; left_it != left_end && batch.size() < batch_size; ++left_it) {
+        batch.push_back(*left_it);
+      }
+      in_flight.push_back(pool.Submit(
+          [&probe, batch = std::move(batch)] { return probe(batch); }));
+    }
+    if (in_flight.empty()) {
+      break;
+    }
+
+    auto next = in_flight.begin();
+    if (!parallelism.ordered) {
+      for (auto it = in_flight.begin(); it != in_flight.end(); ++it) {
+        if (it->wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+          next = it;
+          break;
+        }
+      }
+    }
+    batch_result rows = next->get();
+    in_flight.erase(next);
+
+    for (auto& row : rows) {
+      co_yield row;
+    }
+  }
+}
+
+template <typename RightRange, typename KeyExtractorLeft,
+          typename KeyExtractorRight, typename ValueExtractorLeft,
+          typename ValueExtractorRight>
+class ParallelJoinAdapter {
+public:
+  ParallelJoinAdapter(RightRange right_range,
+                      KeyExtractorLeft key_extractor_left,
+                      KeyExtractorRight key_extractor_right,
+                      ValueExtractorLeft value_extractor_left,
+                      ValueExtractorRight value_extractor_right,
+                      JoinParallelism parallelism)
+      : right_range_(std::move(right_range)),
+        key_extractor_left_(std::move(key_extractor_left)),
+        key_extractor_right_(std::move(key_extractor_right)),
+        value_extractor_left_(std::move(value_extractor_left)),
+        value_extractor_right_(std::move(value_extractor_right)),
+        parallelism_(parallelism) {}
+
+  template <typename LeftRange> auto operator()(LeftRange&& left_range) const {
+    return ParallelJoin<std::decay_t<LeftRange>, RightRange, KeyExtractorLeft,
+                        KeyExtractorRight, ValueExtractorLeft,
+                        ValueExtractorRight>(
+        std::forward<LeftRange>(left_range), right_range_, key_extractor_left_,
+        key_extractor_right_, value_extractor_left_, value_extractor_right_,
+        parallelism_);
+  }
+
+private:
+  RightRange right_range_;
+  KeyExtractorLeft key_extractor_left_;
+  KeyExtractorRight key_extractor_right_;
+  ValueExtractorLeft value_extractor_left_;
+  ValueExtractorRight value_extractor_right_;
+  JoinParallelism parallelism_;
+};
+
+template <typename RightRange>
+auto Join(RightRange&& right_range, JoinParallelism parallelism) {
+  using Element = typename std::decay_t<RightRange>::value_type;
+  return ParallelJoinAdapter<std::decay_t<RightRange>, KeyExtractor<Element>,
+                             KeyExtractor<Element>, ValueExtractor<Element>,
+                             ValueExtractor<Element>>(
+      std::forward<RightRange>(right_range), KeyExtractor<Element>{},
+      KeyExtractor<Element>{}, ValueExtractor<Element>{},
+      ValueExtractor<Element>{}, parallelism);
+}
+
+template <typename RightRange, typename KeyExtractorLeft,
+          typename KeyExtractorRight>
+auto Join(RightRange&& right_range, KeyExtractorLeft key_extractor_left,
+          KeyExtractorRight key_extractor_right, JoinParallelism parallelism) {
+  using Element = typename std::decay_t<RightRange>::value_type;
+  return ParallelJoinAdapter<std::decay_t<RightRange>, KeyExtractorLeft,
+                             KeyExtractorRight, IdentityExtractor<Element>,
+                             IdentityExtractor<Element>>(
+      std::forward<RightRange>(right_range), std::move(key_extractor_left),
+      std::move(key_extractor_right), IdentityExtractor<Element>{},
+      IdentityExtractor<Element>{}, parallelism);
+}
+
+template <typename LeftRange, typename RightRange, typename KeyExtractorLeft,
+          typename KeyExtractorRight, typename ValueExtractorLeft,
+          typename ValueExtractorRight>
+auto operator|(LeftRange&& left_range,
+               const ParallelJoinAdapter<RightRange, KeyExtractorLeft,
+                                         KeyExtractorRight, ValueExtractorLeft,
+                                         ValueExtractorRight>& adapter) {
+  return adapter(std::forward<LeftRange>(left_range));
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "join/join.h"
+#include "materialize/materialize.h"
+
+// Splits a range into `partitions` materialized files in a single pass.
+// An element goes to partition JoinPartition(key_fn(element), partitions),
+// the same mixed high-bit split the joins use, so equal keys always land
+// together, strided integer keys still spread evenly, and every partition
+// can be processed on its own or joined against one split the same way.
+// Each partition owns one buffered writer, so memory stays bounded by
+// partitions * MaterializeWriter::kBufferSize regardless of the input size.
+template <typename KeyFunc>
+class PartitionByOperation {
+public:
+  PartitionByOperation(KeyFunc key_func, std::size_t partitions,
+                       std::filesystem::path directory)
+      : key_func_(std::move(key_func)), partitions_(partitions),
+        directory_(std::move(directory)) {
+    if (partitions_ == 0) {
+      throw std::invalid_argument("PartitionBy: partitions must be positive");
+    }
+  }
+
+  template <typename Range>
+  auto operator|(Range&& range) const {
+    using value_type = typename std::decay_t<Range>::value_type;
+    using key_type = std::decay_t<std::invoke_result_t<KeyFunc, const value_type&>>;
+
+    std::filesystem::create_directories(directory_);
+
+    std::vector<MaterializeWriter<value_type>> writers;
+    writers.reserve(partitions_);
+    for (std::size_t i = 0; i < partitions_; ++i) {
+      writers.emplace_back(PartitionPath(i));
+    }
+
+    for (const auto& item : range) {
+      const key_type& key = key_func_(item);
+      writers[JoinPartition(key, partitions_)].Write(item);
+    }
+
+    std::vector<MaterializedRange<value_type>> result;
+    result.reserve(partitions_);
+    for (auto& writer : writers) {
+      result.push_back(writer.Finish());
+    }
+    return result;
+  }
+
+  std::filesystem::path PartitionPath(std::size_t index) const {
+    return directory_ / ("partition-" + std::to_string(index) + ".bin");
+  }
+
+private:
+  KeyFunc key_func_;
+  std::size_t partitions_;
+  std::filesystem::path directory_;
+};
+
+template <typename KeyFunc>
+auto PartitionBy(KeyFunc key_func, std::size_t partitions,
+                 const std::filesystem::path& directory) {
+  return PartitionByOperation<KeyFunc>(std::move(key_func), partitions,
+                                       directory);
+}
+
+template <typename Range, typename KeyFunc>
+auto operator|(Range&& range, const PartitionByOperation<KeyFunc>& op) {
+  return op.operator|(std::forward<Range>(range));
+}
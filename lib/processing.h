@@ -13,4 +13,24 @@
 #include "drop_nullopt/drop_nullopt.h"
 #include "split_expected/split_expected.h"
 #include "join/join.h"
-#include "aggregate_by_key/aggregate_by_key.h"
\ No newline at end of file
+#include "flat_hash_map/flat_hash_map.h"
+#include "aggregate_by_key/aggregate_by_key.h"
+#include "materialize/materialize.h"
+#include "as_columns/as_columns.h"
+#include "from_generator/from_generator.h"
+#include "channel/channel.h"
+#include "filter_map/filter_map.h"
+#include "tee/tee.h"
+#include "partition_by/partition_by.h"
+#include "merge_join/merge_join.h"
+#include "grace_join/grace_join.h"
+#include "thread_pool/thread_pool.h"
+#include "parallel_join/parallel_join.h"
+#include "mapped_join_index/mapped_join_index.h"
+#include "join_variants/join_variants.h"
+#include "parallel_aggregate_by_key/parallel_aggregate_by_key.h"
+#include "aggregate_consecutive/aggregate_consecutive.h"
+#include "external_aggregate_by_key/external_aggregate_by_key.h"
+#include "top_k_by_key/top_k_by_key.h"
+#include "count_distinct_approx/count_distinct_approx.h"
+#include "adaptive_aggregate_by_key/adaptive_aggregate_by_key.h"
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+
+// How many elements a range is going to produce. Sinks pre-allocate only
+// from exact hints; an inexact hint is an upper bound that may be far off.
+struct SizeHint {
+  std::size_t value;
+  bool exact;
+};
+
+template <typename Range>
+std::optional<SizeHint> GetSizeHint(const Range& range) {
+  if constexpr (requires { range.size_hint(); }) {
+    return range.size_hint();
+  } else if constexpr (requires { range.size(); }) {
+    return SizeHint{static_cast<std::size_t>(range.size()), true};
+  } else {
+    return std::nullopt;
+  }
+}
+
+inline std::optional<SizeHint> AsUpperBound(std::optional<SizeHint> hint) {
+  if (hint) {
+    hint->exact = false;
+  }
+  return hint;
+}
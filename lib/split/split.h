@@ -1,6 +1,8 @@
 #pragma once
 
 #include <fstream>
+#include <memory>
+#include <memory_resource>
 #include <sstream>
 #include <string>
 #include <type_traits>
@@ -8,18 +10,20 @@
 #include <vector>
 
 
-template <typename Iterator> 
+template <typename Iterator, typename String = std::string> 
 class SplitIterator {
 public:
   using iterator_category = std::input_iterator_tag;
-  using value_type = std::string;
+  using value_type = String;
   using difference_type = std::ptrdiff_t;
   using pointer = value_type*;
   using reference = value_type&;
+  using allocator_type = typename String::allocator_type;
 
-  SplitIterator(Iterator current, Iterator end, const std::string& delimiters)
+  SplitIterator(Iterator current, Iterator end, const std::string& delimiters,
+                const allocator_type& allocator = allocator_type())
       : current_(current), end_(end), delimiters_(delimiters),
-        current_index_(0) {
+        tokens_(allocator), current_index_(0) {
     if (current_ != end_) {
       splitCurrentString();
     }
@@ -57,7 +61,9 @@ private:
   Iterator current_;
   Iterator end_;
   std::string delimiters_;
-  mutable std::vector<std::string> tokens_;
+  mutable std::vector<String, typename std::allocator_traits<
+                                  allocator_type>::template rebind_alloc<String>>
+      tokens_;
   size_t current_index_;
 
   void splitCurrentString() const {
@@ -65,7 +71,7 @@ private:
     std::string input = getCurrentContent();
   if (delimiters_.empty()) {
     for (char c : input) {
-      tokens_.push_back(std::string(1, c));
+      tokens_.emplace_back(1, c);
     }
     return;
   }
@@ -78,11 +84,11 @@ private:
     size_t pos = 0;
 
     while ((pos = input.find_first_of(localDelimiters, prev)) != std::string::npos) {
-      tokens_.push_back(input.substr(prev, pos - prev));
+      tokens_.emplace_back(input.data() + prev, pos - prev);
       prev = pos + 1;
     }
 
-    tokens_.push_back(input.substr(prev));
+    tokens_.emplace_back(input.data() + prev, input.size() - prev);
   }
 
   std::string getCurrentContent() const {
@@ -127,23 +133,30 @@ private:
   }
 };
 
-template <typename Range> 
+template <typename Range, typename String = std::string> 
 class SplitRange {
 public:
-  using value_type = std::string;
-  using iterator = SplitIterator<typename std::decay_t<Range>::iterator>;
+  using value_type = String;
+  using iterator =
+      SplitIterator<typename std::decay_t<Range>::iterator, String>;
   using const_iterator =
-      SplitIterator<typename std::decay_t<Range>::const_iterator>;
+      SplitIterator<typename std::decay_t<Range>::const_iterator, String>;
+  using allocator_type = typename String::allocator_type;
 
-  SplitRange(Range&& range, const std::string& delimiters)
-      : range_(std::forward<Range>(range)), delimiters_(delimiters) {}
+  SplitRange(Range&& range, const std::string& delimiters,
+             const allocator_type& allocator = allocator_type())
+      : range_(std::forward<Range>(range)), delimiters_(delimiters),
+        allocator_(allocator) {}
 
-  auto begin() { return iterator(range_.begin(), range_.end(), delimiters_); }
+  auto begin() {
+    return iterator(range_.begin(), range_.end(), delimiters_, allocator_);
+  }
 
   auto end() { return iterator(range_.end()); }
 
   auto begin() const {
-    return const_iterator(range_.begin(), range_.end(), delimiters_);
+    return const_iterator(range_.begin(), range_.end(), delimiters_,
+                          allocator_);
   }
 
   auto end() const { return const_iterator(range_.end()); }
@@ -151,27 +164,40 @@ public:
 private:
   Range range_;
   std::string delimiters_;
+  allocator_type allocator_;
 };
 
+template <typename String = std::string>
 class SplitOperation {
 public:
-  explicit SplitOperation(const std::string& delimiters)
-      : delimiters_(delimiters) {}
+  using allocator_type = typename String::allocator_type;
+
+  explicit SplitOperation(const std::string& delimiters,
+                          const allocator_type& allocator = allocator_type())
+      : delimiters_(delimiters), allocator_(allocator) {}
 
   template <typename Range> 
   auto operator|(Range&& range) const {
-    return SplitRange<Range>(std::forward<Range>(range), delimiters_);
+    return SplitRange<Range, String>(std::forward<Range>(range), delimiters_,
+                                     allocator_);
   }
 
 private:
   std::string delimiters_;
+  allocator_type allocator_;
 };
 
 inline auto Split(const std::string& delimiters) {
-  return SplitOperation(delimiters);
+  return SplitOperation<>(delimiters);
+}
+
+// Tokens are std::pmr::string allocated from the given resource.
+inline auto Split(const std::string& delimiters,
+                  std::pmr::memory_resource* resource) {
+  return SplitOperation<std::pmr::string>(delimiters, resource);
 }
 
-template <typename Range>
-auto operator|(Range&& range, const SplitOperation& op) {
+template <typename Range, typename String>
+auto operator|(Range&& range, const SplitOperation<String>& op) {
   return op | std::forward<Range>(range);
 }
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include <functional>
 #include <utility>
 
+#include "channel/channel.h"
+
 template <typename Parser,typename Iterator>
 class IteratorExpected {
 public:
@@ -95,6 +97,8 @@ public:
   using iterator = IteratorExpected<Parser, range_iterator>;
   
   explicit RangeExpected(Range range) : range_(range) {}
+
+  Range& base() { return range_; }
   
   iterator begin() { 
     return iterator(range_.begin(), range_.end()); 
@@ -115,6 +119,8 @@ public:
   using iterator = IteratorUnexpected<Parser, range_iterator>;
   
   explicit RangeUnexpected(Range range) : range_(range) {}
+
+  Range& base() { return range_; }
   
   iterator begin() { 
     return iterator(range_.begin(), range_.end()); 
@@ -157,4 +163,63 @@ auto SplitExpected(Parser parser_func) {
 template<typename Range, typename Parser>
 auto operator|(Range&& range, const SplitExpectedAdapter<Parser>& split) {
   return split.GetSplitRanges(range);
-}
\ No newline at end of file
+}
+
+// Walks the upstream of a SplitExpected pair once, sending values to one
+// sink and errors to the other. Each sink runs on its own thread behind a
+// bounded Channel, so neither branch has to be buffered in full.
+template <typename ValueSink, typename ErrorSink>
+class RouteOperation {
+public:
+  RouteOperation(ValueSink value_sink, ErrorSink error_sink,
+                 std::size_t capacity)
+      : value_sink_(std::move(value_sink)), error_sink_(std::move(error_sink)),
+        capacity_(capacity) {}
+
+  template <typename Parser, typename Range>
+  auto operator|(std::pair<RangeUnexpected<Parser, Range>,
+                           RangeExpected<Parser, Range>> ranges) const {
+    using value_type =
+        typename RangeExpected<Parser, Range>::iterator::value_type;
+    using error_type =
+        typename RangeUnexpected<Parser, Range>::iterator::value_type;
+
+    ChannelSinkThread<value_type, ValueSink> values(value_sink_, capacity_);
+    ChannelSinkThread<error_type, ErrorSink> errors(error_sink_, capacity_);
+
+    // A sink that throws closes its channel, so a refused push ends the
+    // walk and Finish() rethrows.
+    for (auto&& item : ranges.second.base()) {
+      bool pushed = item.has_value()
+                        ? values.channel().Push(std::move(item).value())
+                        : errors.channel().Push(std::move(item).error());
+      if (!pushed) {
+        break;
+      }
+    }
+
+    auto value_output = values.Finish();
+    auto error_output = errors.Finish();
+    return std::make_pair(std::move(value_output), std::move(error_output));
+  }
+
+private:
+  ValueSink value_sink_;
+  ErrorSink error_sink_;
+  std::size_t capacity_;
+};
+
+template <typename ValueSink, typename ErrorSink>
+auto Route(ValueSink value_sink, ErrorSink error_sink,
+           std::size_t capacity = 1024) {
+  return RouteOperation<ValueSink, ErrorSink>(
+      std::move(value_sink), std::move(error_sink), capacity);
+}
+
+template <typename Parser, typename Range, typename ValueSink,
+          typename ErrorSink>
+auto operator|(std::pair<RangeUnexpected<Parser, Range>,
+                         RangeExpected<Parser, Range>> ranges,
+               const RouteOperation<ValueSink, ErrorSink>& route) {
+  return route.operator|(std::move(ranges));
+}
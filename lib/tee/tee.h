@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "as_data_flow/as_data_flow.h"
+#include "channel/channel.h"
+#include "size_hint/size_hint.h"
+
+// Capacity of the bounded queue in front of each Tee sink thread.
+struct TeeQueue {
+  std::size_t capacity = 1024;
+};
+
+// Opts Tee into buffering the whole upstream in memory and running the
+// sinks one after another on the calling thread.
+struct TeeBuffer {};
+
+// Feeds every element of one upstream pass to several sinks and returns a
+// tuple of their results. Each sink runs on its own thread behind a bounded
+// queue, so memory stays bounded by the queue capacity; TeeBuffer trades
+// that for a single thread and a copy of the whole input.
+template <bool Threaded, typename... Sinks> 
+class TeeOperation {
+public:
+  explicit TeeOperation(TeeQueue queue, Sinks... sinks)
+      : queue_(queue), sinks_(std::move(sinks)...) {}
+
+  template <typename Range> 
+  auto operator|(Range&& range) const {
+    using value_type = typename std::decay_t<Range>::value_type;
+
+    if constexpr (Threaded) {
+      return runThreaded<value_type>(range,
+                                     std::index_sequence_for<Sinks...>());
+    } else {
+      return runBuffered<value_type>(range,
+                                     std::index_sequence_for<Sinks...>());
+    }
+  }
+
+private:
+  TeeQueue queue_;
+  std::tuple<Sinks...> sinks_;
+
+  template <typename T, typename Range, std::size_t... I>
+  auto runBuffered(Range& range, std::index_sequence<I...>) const {
+    std::vector<T> buffer;
+    if (auto hint = GetSizeHint(range); hint && hint->exact) {
+      buffer.reserve(hint->value);
+    }
+    for (const auto& item : range) {
+      buffer.push_back(item);
+    }
+
+    using result_type =
+        std::tuple<decltype(std::declval<AsDataFlowRange<std::vector<T>>>() |
+                            std::get<I>(sinks_))...>;
+    return result_type{(AsDataFlow(buffer) | std::get<I>(sinks_))...};
+  }
+
+  template <typename T, typename Range, std::size_t... I>
+  auto runThreaded(Range& range, std::index_sequence<I...>) const {
+    auto branches = std::make_tuple(
+        std::make_unique<ChannelSinkThread<T, Sinks>>(std::get<I>(sinks_),
+                                                      queue_.capacity)...);
+
+    // A branch whose sink threw closes its channel; stop reading upstream
+    // then and let Finish() rethrow.
+    for (const auto& item : range) {
+      if (!(std::get<I>(branches)->channel().Push(item) && ...)) {
+        break;
+      }
+    }
+
+    using result_type =
+        std::tuple<typename ChannelSinkThread<T, Sinks>::result_type...>;
+    return result_type{std::get<I>(branches)->Finish()...};
+  }
+};
+
+template <typename... Sinks> 
+auto Tee(Sinks... sinks) {
+  return TeeOperation<true, Sinks...>(TeeQueue{}, std::move(sinks)...);
+}
+
+template <typename... Sinks> 
+auto Tee(TeeBuffer, Sinks... sinks) {
+  return TeeOperation<false, Sinks...>(TeeQueue{}, std::move(sinks)...);
+}
+
+template <typename... Sinks> 
+auto Tee(TeeQueue queue, Sinks... sinks) {
+  return TeeOperation<true, Sinks...>(queue, std::move(sinks)...);
+}
+
+template <typename Range, bool Threaded, typename... Sinks>
+auto operator|(Range&& range, const TeeOperation<Threaded, Sinks...>& op) {
+  return op.operator|(std::forward<Range>(range));
+}
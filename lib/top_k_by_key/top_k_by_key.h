@@ -0,0 +1,326 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "aggregate_by_key/aggregate_by_key.h"
+#include "flat_hash_map/flat_hash_map.h"
+
+// One reported key. The true count lies in [count - error, count].
+template <typename Key>
+struct HeavyHitter {
+  Key key;
+  std::size_t count;
+  std::size_t error;
+
+  bool operator==(const HeavyHitter&) const = default;
+};
+
+struct CountMinOptions {
+  std::size_t width = 2048;
+  std::size_t depth = 4;
+};
+
+// Count-Min sketch over key hashes: depth rows of width counters, each key
+// bumping one counter per row. The smallest of its counters never
+// underestimates a key's count and overestimates it by at most
+// e / width * total with probability 1 - e^-depth.
+class CountMinSketch {
+public:
+  explicit CountMinSketch(CountMinOptions options)
+      : width_(std::max<std::size_t>(options.width, 1)),
+        depth_(std::max<std::size_t>(options.depth, 1)),
+        counters_(width_ * depth_) {}
+
+  // Adds weight to the key with this hash and returns its new estimate.
+  std::size_t Add(std::uint64_t hash, std::size_t weight) {
+    std::size_t estimate = SIZE_MAX;
+    for (std::size_t row = 0; row < depth_; ++row) {
+      std::size_t& counter = counters_[row * width_ + column(hash, row)];
+      counter += weight;
+      estimate = std::min(estimate, counter);
+    }
+    return estimate;
+  }
+
+  std::size_t Estimate(std::uint64_t hash) const {
+    std::size_t estimate = SIZE_MAX;
+    for (std::size_t row = 0; row < depth_; ++row) {
+      estimate = std::min(estimate, counters_[row * width_ + column(hash, row)]);
+    }
+    return estimate;
+  }
+
+  void Merge(const CountMinSketch& other) {
+    if (width_ != other.width_ || depth_ != other.depth_) {
+      throw std::invalid_argument("CountMinSketch: merging sketches of different shape");
+    }
+    for (std::size_t i = 0; i < counters_.size(); ++i) {
+      counters_[i] += other.counters_[i];
+    }
+  }
+
+private:
+  std::size_t width_;
+  std::size_t depth_;
+  std::vector<std::size_t> counters_;
+
+  // Row hashes are derived from one 64-bit hash by double hashing.
+  std::size_t column(std::uint64_t hash, std::size_t row) const {
+    std::uint64_t step = (hash >> 32) | 1;
+    return static_cast<std::size_t>(((hash & 0xffffffff) + row * step) % width_);
+  }
+};
+
+// Space-Saving summary of the k heaviest keys. It keeps k counters in an
+// indexed min-heap; a key without a counter takes over the smallest one,
+// inheriting its count as the error. Every key heavier than total / k is
+// guaranteed a counter. With a Count-Min sketch, reported counts are
+// capped by the sketch estimate, which tightens the upper bound of keys
+// that entered late; the counters themselves stay plain Space-Saving so
+// the heap minimum never drops below a count it evicted.
+//
+// Summaries of the same k and sketch shape merge into a summary of the
+// concatenated input, so partial results of parallel or incremental runs
+// can be combined.
+template <typename Key, typename Hash = FlatHash<Key>>
+class SpaceSaving {
+public:
+  explicit SpaceSaving(std::size_t k,
+                       std::optional<CountMinOptions> sketch = std::nullopt)
+      : k_(std::max<std::size_t>(k, 1)) {
+    if (sketch) {
+      sketch_.emplace(*sketch);
+    }
+    counters_.reserve(k_);
+    heap_.reserve(k_);
+    positions_.reserve(k_);
+    index_.reserve(k_);
+  }
+
+  template <typename K>
+  void Add(K&& key, std::size_t weight = 1) {
+    total_ += weight;
+    if (sketch_) {
+      sketch_->Add(hash_(key), weight);
+    }
+
+    if (auto it = index_.find(key); it != index_.end()) {
+      counters_[it->second].count += weight;
+      siftDown(positions_[it->second]);
+      return;
+    }
+
+    if (counters_.size() < k_) {
+      std::size_t slot = counters_.size();
+      counters_.push_back({Key(std::forward<K>(key)), weight, 0});
+      index_.emplace(counters_.back().key, slot);
+      heap_.push_back(slot);
+      positions_.push_back(slot);
+      siftUp(slot);
+      return;
+    }
+
+    std::size_t slot = heap_.front();
+    HeavyHitter<Key>& counter = counters_[slot];
+    std::size_t evicted = counter.count;
+    index_.erase(counter.key);
+    counter = {Key(std::forward<K>(key)), evicted + weight, evicted};
+    index_.emplace(counter.key, slot);
+    siftDown(0);
+  }
+
+  void Merge(const SpaceSaving& other) {
+    if (k_ != other.k_ || sketch_.has_value() != other.sketch_.has_value()) {
+      throw std::invalid_argument("SpaceSaving: merging summaries of different shape");
+    }
+    if (sketch_) {
+      sketch_->Merge(*other.sketch_);
+    }
+
+    // A key missing from a full summary may still have occurred there up
+    // to that summary's smallest count.
+    std::size_t missing_here = counters_.size() < k_ ? 0 : minCount();
+    std::size_t missing_there = other.counters_.size() < k_ ? 0 : other.minCount();
+
+    std::vector<HeavyHitter<Key>> merged = std::move(counters_);
+    for (auto& counter : merged) {
+      if (auto it = other.index_.find(counter.key); it != other.index_.end()) {
+        counter.count += other.counters_[it->second].count;
+        counter.error += other.counters_[it->second].error;
+      } else {
+        counter.count += missing_there;
+        counter.error += missing_there;
+      }
+    }
+    for (const auto& counter : other.counters_) {
+      if (!index_.contains(counter.key)) {
+        merged.push_back({counter.key, counter.count + missing_here,
+                          counter.error + missing_here});
+      }
+    }
+    total_ += other.total_;
+
+    if (merged.size() > k_) {
+      std::nth_element(merged.begin(), merged.begin() + k_, merged.end(),
+                       [](const auto& lhs, const auto& rhs) {
+                         return lhs.count > rhs.count;
+                       });
+      merged.resize(k_);
+    }
+    rebuild(std::move(merged));
+  }
+
+  // The tracked keys, heaviest first.
+  std::vector<HeavyHitter<Key>> Top() const {
+    std::vector<HeavyHitter<Key>> result = counters_;
+    if (sketch_) {
+      for (auto& hitter : result) {
+        std::size_t lower = hitter.count - hitter.error;
+        hitter.count = std::min(hitter.count, sketch_->Estimate(hash_(hitter.key)));
+        hitter.error = hitter.count - lower;
+      }
+    }
+    std::sort(result.begin(), result.end(), [](const auto& lhs, const auto& rhs) {
+      return lhs.count != rhs.count ? lhs.count > rhs.count : lhs.error < rhs.error;
+    });
+    return result;
+  }
+
+  // Upper bound on the count of any key, tracked or not.
+  template <typename K>
+  std::size_t Estimate(const K& key) const {
+    std::size_t estimate = counters_.size() < k_ ? 0 : minCount();
+    if (auto it = index_.find(key); it != index_.end()) {
+      estimate = counters_[it->second].count;
+    }
+    if (sketch_) {
+      estimate = std::min(estimate, sketch_->Estimate(hash_(key)));
+    }
+    return estimate;
+  }
+
+  std::size_t Capacity() const { return k_; }
+
+  // Total weight added, the N in the total / k error bound.
+  std::size_t Total() const { return total_; }
+
+private:
+  std::size_t k_;
+  std::size_t total_ = 0;
+  Hash hash_;
+  std::optional<CountMinSketch> sketch_;
+  std::vector<HeavyHitter<Key>> counters_;
+  // heap_ holds counter slots ordered by count, positions_ maps a slot
+  // back to its place in heap_.
+  std::vector<std::size_t> heap_;
+  std::vector<std::size_t> positions_;
+  std::unordered_map<Key, std::size_t, Hash, std::equal_to<>> index_;
+
+  std::size_t minCount() const {
+    return heap_.empty() ? 0 : counters_[heap_.front()].count;
+  }
+
+  void rebuild(std::vector<HeavyHitter<Key>> counters) {
+    counters_ = std::move(counters);
+    index_.clear();
+    heap_.clear();
+    positions_.clear();
+    for (std::size_t slot = 0; slot < counters_.size(); ++slot) {
+      index_.emplace(counters_[slot].key, slot);
+      heap_.push_back(slot);
+      positions_.push_back(slot);
+    }
+    for (std::size_t i = heap_.size() / 2; i-- > 0;) {
+      siftDown(i);
+    }
+  }
+
+  bool less(std::size_t lhs, std::size_t rhs) const {
+    return counters_[heap_[lhs]].count < counters_[heap_[rhs]].count;
+  }
+
+  void swapNodes(std::size_t lhs, std::size_t rhs) {
+    std::swap(heap_[lhs], heap_[rhs]);
+    positions_[heap_[lhs]] = lhs;
+    positions_[heap_[rhs]] = rhs;
+  }
+
+  void siftUp(std::size_t node) {
+    while (node > 0 && less(node, (node - 1) / 2)) {
+      swapNodes(node, (node - 1) / 2);
+      node = (node - 1) / 2;
+    }
+  }
+
+  void siftDown(std::size_t node) {
+    while (true) {
+      std::size_t smallest = node;
+      for (std::size_t child = 2 * node + 1; child <= 2 * node + 2; ++child) {
+        if (child < heap_.size() && less(child, smallest)) {
+          smallest = child;
+        }
+      }
+      if (smallest == node) {
+        return;
+      }
+      swapNodes(node, smallest);
+      node = smallest;
+    }
+  }
+};
+
+template <typename KeyExtractorFunc>
+class TopKByKeyOperation {
+public:
+  TopKByKeyOperation(std::size_t k, KeyExtractorFunc keyExtractor,
+                     std::optional<CountMinOptions> sketch)
+      : k_(k), keyExtractor_(std::move(keyExtractor)), sketch_(sketch) {}
+
+  template <typename Range>
+  auto operator|(Range&& range) const {
+    using Element = typename std::decay_t<Range>::value_type;
+    using Key = typename AggregateStoredKey<std::decay_t<
+        decltype(keyExtractor_(std::declval<const Element&>()))>>::type;
+
+    SpaceSaving<Key> summary(k_, sketch_);
+    for (const auto& element : range) {
+      summary.Add(keyExtractor_(element));
+    }
+    return summary;
+  }
+
+private:
+  std::size_t k_;
+  KeyExtractorFunc keyExtractor_;
+  std::optional<CountMinOptions> sketch_;
+};
+
+// Counts keys into a SpaceSaving summary of k counters; call Top() on the
+// result for the heaviest keys with their error bounds.
+template <typename KeyExtractorFunc>
+auto TopKByKey(std::size_t k, KeyExtractorFunc keyExtractor) {
+  return TopKByKeyOperation<KeyExtractorFunc>(k, std::move(keyExtractor),
+                                              std::nullopt);
+}
+
+template <typename KeyExtractorFunc>
+auto TopKByKey(std::size_t k, KeyExtractorFunc keyExtractor,
+               CountMinOptions sketch) {
+  return TopKByKeyOperation<KeyExtractorFunc>(k, std::move(keyExtractor),
+                                              sketch);
+}
+
+template <typename Range, typename KeyExtractorFunc>
+auto operator|(Range&& range,
+               const TopKByKeyOperation<KeyExtractorFunc>& operation) {
+  return operation.operator|(std::forward<Range>(range));
+}
@@ -1,24 +1,51 @@
 #pragma once
 
+#include <compare>
+#include <concepts>
+#include <iterator>
+#include <optional>
 #include <type_traits>
 #include <utility>
 
+#include "size_hint/size_hint.h"
+
 template <typename Iterator, typename UnaryFunction>
 class TransformIterator {
 public:
 
-  using iterator_category = typename Iterator::iterator_category;
-  using difference_type = typename Iterator::difference_type;
+  using iterator_category =
+      typename std::iterator_traits<Iterator>::iterator_category;
+  using difference_type =
+      typename std::iterator_traits<Iterator>::difference_type;
 
   using value_type = std::decay_t<decltype(std::declval<UnaryFunction>()(*std::declval<Iterator>()))>;
   using pointer = value_type*;
-  using reference = value_type&;
+  using reference = value_type;
+
+  // The function is held in an optional so that the iterator stays default
+  // constructible and copy assignable, as std::random_access_iterator
+  // requires, even for lambdas with captures.
+  TransformIterator()
+    requires std::default_initializable<Iterator>
+  = default;
 
   TransformIterator(Iterator it, UnaryFunction func)
-    : current_(it), func_(func) {}
+    : current_(it), func_(std::move(func)) {}
+
+  TransformIterator(const TransformIterator&) = default;
+
+  TransformIterator& operator=(const TransformIterator& other) {
+    current_ = other.current_;
+    if (other.func_) {
+      func_.emplace(*other.func_);
+    } else {
+      func_.reset();
+    }
+    return *this;
+  }
 
   auto operator*() const {
-    return func_(*current_);
+    return (*func_)(*current_);
   }
 
   TransformIterator& operator++() {
@@ -26,13 +53,93 @@ public:
     return *this;
   }
 
+  TransformIterator operator++(int) {
+    TransformIterator copy = *this;
+    ++current_;
+    return copy;
+  }
+
   bool operator!=(const TransformIterator& other) const {
     return current_ != other.current_;
   }
 
+  bool operator==(const TransformIterator& other) const
+    requires requires(const Iterator& it) { it == it; }
+  {
+    return current_ == other.current_;
+  }
+
+  // Bidirectional and random-access operations are available whenever the
+  // underlying iterator provides them.
+  TransformIterator& operator--()
+    requires requires(Iterator& it) { --it; }
+  {
+    --current_;
+    return *this;
+  }
+
+  TransformIterator operator--(int)
+    requires requires(Iterator& it) { --it; }
+  {
+    TransformIterator copy = *this;
+    --current_;
+    return copy;
+  }
+
+  TransformIterator& operator+=(difference_type n)
+    requires std::random_access_iterator<Iterator>
+  {
+    current_ += n;
+    return *this;
+  }
+
+  TransformIterator& operator-=(difference_type n)
+    requires std::random_access_iterator<Iterator>
+  {
+    current_ -= n;
+    return *this;
+  }
+
+  TransformIterator operator+(difference_type n) const
+    requires std::random_access_iterator<Iterator>
+  {
+    return TransformIterator(current_ + n, *func_);
+  }
+
+  friend TransformIterator operator+(difference_type n,
+                                     const TransformIterator& it)
+    requires std::random_access_iterator<Iterator>
+  {
+    return it + n;
+  }
+
+  TransformIterator operator-(difference_type n) const
+    requires std::random_access_iterator<Iterator>
+  {
+    return TransformIterator(current_ - n, *func_);
+  }
+
+  difference_type operator-(const TransformIterator& other) const
+    requires std::random_access_iterator<Iterator>
+  {
+    return current_ - other.current_;
+  }
+
+  auto operator[](difference_type n) const
+    requires std::random_access_iterator<Iterator>
+  {
+    return (*func_)(current_[n]);
+  }
+
+  auto operator<=>(const TransformIterator& other) const
+    requires std::random_access_iterator<Iterator>
+  {
+    return current_ <=> other.current_;
+  }
+
 private:
-  Iterator current_;
-  UnaryFunction func_;
+  Iterator current_{};
+  std::optional<UnaryFunction> func_;
 };
 
 template <typename Range, typename UnaryFunction>
@@ -53,6 +160,16 @@ public:
     return iterator(range_.end(), func_);
   }
 
+  const_iterator begin() const {
+    return const_iterator(range_.begin(), func_);
+  }
+
+  const_iterator end() const {
+    return const_iterator(range_.end(), func_);
+  }
+
+  std::optional<SizeHint> size_hint() const { return GetSizeHint(range_); }
+
 private:
   Range range_;
   UnaryFunction func_;
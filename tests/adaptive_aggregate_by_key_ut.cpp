@@ -0,0 +1,105 @@
+#include <processing.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// count elements with keys drawn uniformly from `keys` distinct words.
+std::vector<KV<std::string, int>> RandomWords(int count, int keys) {
+    std::minstd_rand random(42);
+    std::uniform_int_distribution<int> key(0, keys - 1);
+    std::vector<KV<std::string, int>> input;
+    for (int i = 0; i < count; ++i) {
+        input.push_back({"word" + std::to_string(key(random)), i % 7});
+    }
+    return input;
+}
+
+auto Sum() {
+    return [](const KV<std::string, int>& kv, long long& sum) { sum += kv.value; };
+}
+
+auto ByWord() {
+    return [](const KV<std::string, int>& kv) -> const std::string& { return kv.key; };
+}
+
+auto Expected(std::vector<KV<std::string, int>>& input) {
+    return AsDataFlow(input) | AggregateByKey(0ll, Sum(), ByWord()) | AsVector();
+}
+
+AggregationStats Aggregate(std::vector<KV<std::string, int>>& input, AggregationOptions options) {
+    AggregationStats stats;
+    options.on_stats = [&](const AggregationStats& reported) { stats = reported; };
+    auto result = AsDataFlow(input) | AggregateByKey(0ll, Sum(), ByWord(), options) | AsVector();
+    EXPECT_EQ(result, Expected(input));
+    EXPECT_EQ(stats.groups, result.size());
+    return stats;
+}
+
+}
+
+TEST(AdaptiveAggregateByKeyTest, FewKeysUseFlatTable) {
+    auto input = RandomWords(50000, 100);
+    auto stats = Aggregate(input, {});
+    ASSERT_EQ(stats.strategy, AggregationStrategy::Flat);
+    ASSERT_EQ(stats.sampled, 4096);
+    ASSERT_EQ(stats.sample_distinct, 100);
+    ASSERT_EQ(stats.estimated_groups, 100);
+}
+
+TEST(AdaptiveAggregateByKeyTest, UniqueKeysAreSorted) {
+    auto input = RandomWords(100000, 1000000000);
+    AggregationOptions options;
+    options.cache_bytes = 64 * 1024;
+    auto stats = Aggregate(input, options);
+    ASSERT_EQ(stats.strategy, AggregationStrategy::Sort);
+    ASSERT_GT(stats.estimated_groups, 10000);
+}
+
+TEST(AdaptiveAggregateByKeyTest, RepeatedKeysArePartitioned) {
+    auto input = RandomWords(200000, 5000);
+    AggregationOptions options;
+    options.cache_bytes = 64 * 1024;
+    auto stats = Aggregate(input, options);
+    ASSERT_EQ(stats.strategy, AggregationStrategy::Partitioned);
+    ASSERT_GT(stats.partitions, 1);
+    ASSERT_EQ(stats.groups, 5000);
+}
+
+TEST(AdaptiveAggregateByKeyTest, ForcedStrategiesAgree) {
+    auto input = RandomWords(20000, 3000);
+    for (auto strategy : {AggregationStrategy::Flat, AggregationStrategy::Partitioned,
+                          AggregationStrategy::Sort}) {
+        AggregationOptions options;
+        options.strategy = strategy;
+        options.sample_size = 100;
+        auto stats = Aggregate(input, options);
+        ASSERT_EQ(stats.strategy, strategy);
+    }
+}
+
+TEST(AdaptiveAggregateByKeyTest, LargeInputFallsBackToFlat) {
+    auto input = RandomWords(20000, 3000);
+    for (auto strategy : {AggregationStrategy::Partitioned, AggregationStrategy::Sort}) {
+        AggregationOptions options;
+        options.strategy = strategy;
+        options.sample_size = 100;
+        options.max_buffered_bytes = 64 * 1024;
+        auto stats = Aggregate(input, options);
+        ASSERT_EQ(stats.strategy, AggregationStrategy::Flat);
+        ASSERT_GT(stats.estimated_buffer_bytes, options.max_buffered_bytes);
+    }
+}
+
+TEST(AdaptiveAggregateByKeyTest, InputShorterThanSample) {
+    std::vector<KV<std::string, int>> input = {{"b", 1}, {"a", 2}, {"b", 3}};
+    auto stats = Aggregate(input, {});
+    ASSERT_EQ(stats.strategy, AggregationStrategy::Flat);
+    ASSERT_EQ(stats.estimated_groups, 2);
+}
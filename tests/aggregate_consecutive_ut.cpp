@@ -0,0 +1,76 @@
+#include <processing.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+TEST(AggregateConsecutiveTest, SumsRuns) {
+    std::vector<KV<int, int>> input = {{1, 1}, {1, 2}, {2, 5}, {3, 1}, {3, 1}, {1, 7}};
+    auto result =
+        AsDataFlow(input)
+        | AggregateConsecutive(
+            0,
+            [](const KV<int, int>& kv, int& sum) { sum += kv.value; },
+            [](const KV<int, int>& kv) { return kv.key; })
+        | AsVector();
+
+    ASSERT_THAT(result, testing::ElementsAre(
+        std::make_pair(1, 3), std::make_pair(2, 5), std::make_pair(3, 2), std::make_pair(1, 7)));
+}
+
+namespace {
+
+Generator<int> EndlessPairs() {
+    for (int i = 0;; ++i) {
+        co_yield i;
+        co_yield i;
+    }
+}
+
+}
+
+TEST(AggregateConsecutiveTest, EmitsBeforeInputIsExhausted) {
+    auto groups =
+        FromGenerator(EndlessPairs())
+        | AggregateConsecutive(
+            0,
+            [](int, int& count) { ++count; },
+            [](int x) { return x; });
+
+    auto it = groups.begin();
+    ASSERT_EQ(*it, std::make_pair(0, 2));
+    ++it;
+    ASSERT_EQ(*it, std::make_pair(1, 2));
+    ++it;
+    ASSERT_EQ(*it, std::make_pair(2, 2));
+}
+
+TEST(AggregateConsecutiveTest, StringViewKeysOverTokens) {
+    std::vector<std::stringstream> files(1);
+    files[0] << "a a b b b a";
+    auto result =
+        AsDataFlow(files)
+        | Split(" ")
+        | AggregateConsecutive(
+            0,
+            [](const std::string&, int& count) { ++count; },
+            [](const std::string& token) -> std::string_view { return token; })
+        | AsVector();
+
+    ASSERT_THAT(result, testing::ElementsAre(
+        std::make_pair(std::string("a"), 2), std::make_pair(std::string("b"), 3),
+        std::make_pair(std::string("a"), 1)));
+}
+
+TEST(AggregateConsecutiveTest, Empty) {
+    std::vector<int> input;
+    auto result =
+        AsDataFlow(input)
+        | AggregateConsecutive(0, [](int, int& count) { ++count; }, [](int x) { return x; })
+        | AsVector();
+    ASSERT_TRUE(result.empty());
+}
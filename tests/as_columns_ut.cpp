@@ -0,0 +1,72 @@
+#include <processing.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+struct Measurement {
+    int sensor;
+    double value;
+    std::string unit;
+};
+
+TEST(AsColumnsTest, Pairs) {
+    std::vector<std::pair<std::string, int>> input = {{"a", 1}, {"b", 2}, {"c", 3}};
+    auto columns = AsDataFlow(input) | AsColumns();
+
+    ASSERT_EQ(columns.size(), 3);
+    ASSERT_THAT(columns.column<0>(), testing::ElementsAre("a", "b", "c"));
+    ASSERT_THAT(columns.column<1>(), testing::ElementsAre(1, 2, 3));
+}
+
+TEST(AsColumnsTest, KeyValueAndJoinResult) {
+    std::vector<KV<int, std::string>> left = {{0, "a"}, {1, "b"}};
+    std::vector<KV<int, std::string>> right = {{0, "f"}};
+
+    auto kv_columns = AsDataFlow(left) | AsColumns();
+    ASSERT_THAT(kv_columns.column<0>(), testing::ElementsAre(0, 1));
+
+    auto joined = AsDataFlow(left) | Join(AsDataFlow(right)) | AsColumns();
+    ASSERT_THAT(joined.column<0>(), testing::ElementsAre("a", "b"));
+    ASSERT_THAT(joined.column<1>(), testing::ElementsAre(std::optional<std::string>{"f"}, std::nullopt));
+}
+
+TEST(AsColumnsTest, StructFieldList) {
+    std::vector<Measurement> input = {{1, 0.5, "C"}, {2, 1.5, "K"}};
+    auto columns = AsDataFlow(input) | AsColumns(&Measurement::sensor, &Measurement::value);
+
+    ASSERT_THAT(columns.column<0>(), testing::ElementsAre(1, 2));
+    ASSERT_THAT(columns.column<1>(), testing::ElementsAre(0.5, 1.5));
+}
+
+TEST(AsColumnsTest, ReZipAsDataFlow) {
+    std::vector<std::tuple<int, std::string, double>> input = {{1, "x", 0.1}, {2, "y", 0.2}};
+    auto columns = AsDataFlow(input) | AsColumns();
+
+    auto result = AsDataFlow(columns)
+        | Transform([](const auto& row) { return std::get<1>(row) + std::to_string(std::get<0>(row)); })
+        | AsVector();
+    ASSERT_THAT(result, testing::ElementsAre("x1", "y2"));
+
+    auto rows = AsDataFlow(columns) | AsVector();
+    ASSERT_EQ(rows, input);
+}
+
+TEST(AsColumnsTest, ScanSingleColumn) {
+    std::vector<std::pair<std::string, int>> input = {{"a", 1}, {"b", 2}, {"c", 3}};
+    auto columns = AsDataFlow(input) | AsColumns();
+
+    auto result = AsDataFlow(columns.column<1>()) | Filter([](int x) { return x > 1; }) | AsVector();
+    ASSERT_THAT(result, testing::ElementsAre(2, 3));
+}
+
+TEST(AsColumnsTest, Empty) {
+    std::vector<std::pair<int, int>> input;
+    auto columns = AsDataFlow(input) | AsColumns();
+    ASSERT_TRUE(columns.empty());
+    ASSERT_TRUE((AsDataFlow(columns) | AsVector()).empty());
+}
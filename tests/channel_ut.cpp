@@ -0,0 +1,129 @@
+#include <processing.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// No default constructor and no assignment, as FromChannel must allow.
+struct Token {
+    explicit Token(int id) : id(id) {}
+    Token(Token&&) = default;
+    Token& operator=(Token&&) = delete;
+
+    int id;
+};
+
+}
+
+TEST(ChannelTest, TryPushTryPop) {
+    Channel<int> channel(2);
+    int value = 0;
+    ASSERT_FALSE(channel.TryPop(value));
+    ASSERT_TRUE(channel.TryPush(1));
+    ASSERT_TRUE(channel.TryPush(2));
+    ASSERT_FALSE(channel.TryPush(3));
+    ASSERT_TRUE(channel.TryPop(value));
+    ASSERT_EQ(value, 1);
+    ASSERT_TRUE(channel.TryPop(value));
+    ASSERT_EQ(value, 2);
+}
+
+TEST(ChannelTest, TryPushKeepsLvalueAndRejectsClosed) {
+    Channel<std::string> channel(2);
+    std::string value = "kept";
+    ASSERT_TRUE(channel.TryPush(value));
+    ASSERT_EQ(value, "kept");
+    channel.Close();
+    ASSERT_FALSE(channel.TryPush(value));
+    ASSERT_FALSE(channel.TryPush(std::string("late")));
+    auto result = FromChannel(channel) | AsVector();
+    ASSERT_THAT(result, testing::ElementsAre("kept"));
+}
+
+TEST(ChannelTest, ClosedAndDrained) {
+    Channel<std::string> channel(4);
+    ASSERT_TRUE(channel.Push("a"));
+    channel.Close();
+    ASSERT_FALSE(channel.Push("b"));
+    auto result = FromChannel(channel) | AsVector();
+    ASSERT_THAT(result, testing::ElementsAre("a"));
+}
+
+TEST(ChannelTest, PipelineAcrossThreads) {
+    Channel<int> input(8);
+    Channel<int> output(8);
+
+    std::thread producer([&input] {
+        std::vector<int> values(1000);
+        std::iota(values.begin(), values.end(), 0);
+        AsDataFlow(values) | ToChannel(input);
+    });
+
+    std::thread worker([&input, &output] {
+        FromChannel(input)
+            | Filter([](int x) { return x % 2 == 0; })
+            | Transform([](int x) { return x * 3; })
+            | ToChannel(output);
+    });
+
+    auto result = FromChannel(output) | AsVector();
+    producer.join();
+    worker.join();
+
+    ASSERT_EQ(result.size(), 500);
+    for (size_t i = 0; i < result.size(); ++i) {
+        ASSERT_EQ(result[i], static_cast<int>(i) * 6);
+    }
+}
+
+TEST(ChannelTest, MultipleProducers) {
+    Channel<int> channel(16);
+    constexpr int kProducers = 4;
+    constexpr int kPerProducer = 2000;
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&channel] {
+            for (int i = 1; i <= kPerProducer; ++i) {
+                channel.Push(i);
+            }
+        });
+    }
+    std::thread closer([&] {
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        channel.Close();
+    });
+
+    long long sum = 0;
+    for (int value : FromChannel(channel)) {
+        sum += value;
+    }
+    closer.join();
+
+    ASSERT_EQ(sum, static_cast<long long>(kProducers) * kPerProducer * (kPerProducer + 1) / 2);
+}
+
+TEST(ChannelTest, FromChannelWithoutDefaultConstructor) {
+    Channel<Token> channel(4);
+    ASSERT_TRUE(channel.Push(Token(1)));
+    ASSERT_TRUE(channel.Push(Token(2)));
+    channel.Close();
+
+    std::vector<int> ids;
+    for (const Token& token : FromChannel(channel)) {
+        ids.push_back(token.id);
+    }
+    ASSERT_THAT(ids, testing::ElementsAre(1, 2));
+
+    std::optional<Token> last;
+    ASSERT_FALSE(channel.TryPop(last));
+    ASSERT_FALSE(last.has_value());
+}
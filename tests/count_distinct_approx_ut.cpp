@@ -0,0 +1,74 @@
+#include <processing.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::string> Tokens(int distinct, int repeats, int offset = 0) {
+    std::vector<std::string> tokens;
+    for (int round = 0; round < repeats; ++round) {
+        for (int i = 0; i < distinct; ++i) {
+            tokens.push_back("token" + std::to_string(offset + i));
+        }
+    }
+    return tokens;
+}
+
+auto Identity() {
+    return [](const std::string& token) -> const std::string& { return token; };
+}
+
+double RelativeError(size_t estimate, size_t actual) {
+    return std::abs(static_cast<double>(estimate) - static_cast<double>(actual)) / actual;
+}
+
+}
+
+TEST(CountDistinctApproxTest, ExactForSmallCardinality) {
+    auto tokens = Tokens(300, 3);
+    auto sketch = AsDataFlow(tokens) | CountDistinctApprox(12, Identity());
+    ASSERT_TRUE(sketch.IsExact());
+    ASSERT_EQ(sketch.Estimate(), 300);
+}
+
+TEST(CountDistinctApproxTest, EstimatesLargeCardinality) {
+    auto tokens = Tokens(100000, 2);
+    auto sketch = AsDataFlow(tokens) | CountDistinctApprox(12, Identity());
+    ASSERT_FALSE(sketch.IsExact());
+    EXPECT_LT(RelativeError(sketch.Estimate(), 100000), 0.05);
+}
+
+TEST(CountDistinctApproxTest, LinearCountingForSmallDenseSketch) {
+    auto tokens = Tokens(1000, 1);
+    auto sketch = AsDataFlow(tokens) | CountDistinctApprox(12, Identity(), 0);
+    ASSERT_FALSE(sketch.IsExact());
+    EXPECT_LT(RelativeError(sketch.Estimate(), 1000), 0.05);
+}
+
+TEST(CountDistinctApproxTest, MergedSketchesCountUnion) {
+    auto first = Tokens(60000, 1);
+    auto second = Tokens(60000, 1, 30000);
+    auto small = Tokens(100, 1, 200000);
+
+    auto merged = AsDataFlow(first) | CountDistinctApprox(14, Identity());
+    merged.Merge(AsDataFlow(second) | CountDistinctApprox(14, Identity()));
+    merged.Merge(AsDataFlow(small) | CountDistinctApprox(14, Identity()));
+    EXPECT_LT(RelativeError(merged.Estimate(), 90100), 0.03);
+
+    auto exact = AsDataFlow(small) | CountDistinctApprox(14, Identity());
+    exact.Merge(AsDataFlow(small) | CountDistinctApprox(14, Identity()));
+    ASSERT_TRUE(exact.IsExact());
+    ASSERT_EQ(exact.Estimate(), 100);
+}
+
+TEST(CountDistinctApproxTest, RejectsBadPrecision) {
+    ASSERT_THROW(HyperLogLog(3), std::invalid_argument);
+    HyperLogLog lhs(10);
+    HyperLogLog rhs(11);
+    ASSERT_THROW(lhs.Merge(rhs), std::invalid_argument);
+}
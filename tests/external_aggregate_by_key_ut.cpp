@@ -0,0 +1,86 @@
+#include <processing.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+std::vector<KV<std::string, int>> Words(int count) {
+    std::vector<KV<std::string, int>> input;
+    for (int i = 0; i < count; ++i) {
+        input.push_back({"word" + std::to_string(i * 7919 % 1000), i});
+    }
+    return input;
+}
+
+auto SumByKey(MemoryBudget budget) {
+    return AggregateByKey(
+        0,
+        [](const KV<std::string, int>& kv, int& sum) { sum += kv.value; },
+        [](const KV<std::string, int>& kv) { return kv.key; },
+        [](int& sum, int other) { sum += other; },
+        std::move(budget));
+}
+
+std::filesystem::path SpillParent(const std::string& name) {
+    auto path = std::filesystem::temp_directory_path() / ("ranges_external_aggregate_" + name);
+    std::filesystem::create_directories(path);
+    return path;
+}
+
+}
+
+TEST(ExternalAggregateByKeyTest, SpilledRunsMatchInMemoryResult) {
+    auto input = Words(20000);
+    auto expected =
+        AsDataFlow(input)
+        | AggregateByKey(
+            0,
+            [](const KV<std::string, int>& kv, int& sum) { sum += kv.value; },
+            [](const KV<std::string, int>& kv) { return kv.key; })
+        | AsVector();
+    std::sort(expected.begin(), expected.end());
+
+    auto parent = SpillParent("spilled");
+    auto result = AsDataFlow(input) | SumByKey({.bytes = 4096, .spill_directory = parent}) | AsVector();
+
+    ASSERT_EQ(result, expected);
+    ASSERT_TRUE(std::filesystem::is_empty(parent));
+    std::filesystem::remove(parent);
+}
+
+TEST(ExternalAggregateByKeyTest, FitsInBudget) {
+    std::vector<KV<std::string, int>> input = {{"b", 1}, {"a", 2}, {"b", 3}};
+    auto result = AsDataFlow(input) | SumByKey({.bytes = 1 << 20}) | AsVector();
+    ASSERT_THAT(result, testing::ElementsAre(
+        std::make_pair(std::string("a"), 2), std::make_pair(std::string("b"), 4)));
+}
+
+TEST(ExternalAggregateByKeyTest, EmptyInput) {
+    std::vector<KV<std::string, int>> input;
+    auto result = AsDataFlow(input) | SumByKey({.bytes = 0}) | AsVector();
+    ASSERT_TRUE(result.empty());
+}
+
+TEST(ExternalAggregateByKeyTest, MergesManyRunsInPasses) {
+    auto input = Words(3000);
+    std::map<std::string, int> expected;
+    for (const auto& kv : input) {
+        expected[kv.key] += kv.value;
+    }
+
+    auto parent = SpillParent("passes");
+    auto result = AsDataFlow(input) | SumByKey({.bytes = 1, .spill_directory = parent}) | AsVector();
+
+    std::vector<std::pair<std::string, int>> sums(expected.begin(), expected.end());
+    ASSERT_EQ(result, sums);
+    ASSERT_TRUE(std::filesystem::is_empty(parent));
+    std::filesystem::remove(parent);
+}
@@ -0,0 +1,64 @@
+#include <processing.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::optional<int> ParsePositive(const std::string& str) {
+    if (str.empty() || str.find_first_not_of("0123456789") != std::string::npos) {
+        return std::nullopt;
+    }
+    return std::stoi(str);
+}
+
+}
+
+TEST(FilterMapTest, ParseTokens) {
+    std::vector<std::stringstream> files(1);
+    files[0] << "1 x 22  333 -4";
+    auto result = AsDataFlow(files) | Split(" ") | FilterMap(ParsePositive) | AsVector();
+    ASSERT_THAT(result, testing::ElementsAre(1, 22, 333));
+}
+
+TEST(FilterMapTest, CallsFunctionOncePerElement) {
+    std::vector<int> input = {1, 2, 3, 4, 5, 6};
+    int calls = 0;
+    auto result = AsDataFlow(input)
+        | FilterMap([&calls](int x) -> std::optional<int> {
+            ++calls;
+            if (x % 2 == 0) {
+                return x * 10;
+            }
+            return std::nullopt;
+        })
+        | AsVector();
+    ASSERT_THAT(result, testing::ElementsAre(20, 40, 60));
+    ASSERT_EQ(calls, 6);
+}
+
+TEST(FilterMapTest, AllNullopt) {
+    std::vector<std::string> input = {"a", "b"};
+    auto result = AsDataFlow(input) | FilterMap(ParsePositive) | AsVector();
+    ASSERT_TRUE(result.empty());
+}
+
+TEST(FilterMapTest, Empty) {
+    std::vector<std::string> input;
+    auto result = AsDataFlow(input) | FilterMap(ParsePositive) | AsVector();
+    ASSERT_TRUE(result.empty());
+}
+
+TEST(FilterMapTest, ResultType) {
+    std::vector<int> input = {1, 2};
+    auto result = AsDataFlow(input)
+        | FilterMap([](int x) { return std::optional<std::string>(std::to_string(x)); })
+        | AsVector();
+    ASSERT_TRUE((std::is_same_v<decltype(result), std::vector<std::string>>));
+    ASSERT_THAT(result, testing::ElementsAre("1", "2"));
+}
@@ -0,0 +1,59 @@
+#include <processing.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+TEST(FlatHashMapTest, InsertionOrderAndGrowth) {
+    FlatHashMap<int, int> map;
+    for (int i = 0; i < 1000; ++i) {
+        map[i * 7 % 1000] += i;
+    }
+    ASSERT_EQ(map.size(), 1000);
+    ASSERT_EQ(map.begin()->first, 0);
+    ASSERT_EQ((map.begin() + 1)->first, 7);
+    ASSERT_EQ(map.find(7)->second, 1);
+    ASSERT_EQ(map.find(1000), map.end());
+}
+
+TEST(FlatHashMapTest, HeterogeneousLookup) {
+    FlatHashMap<std::string, int> map;
+    std::string_view key = "apple";
+    auto [it, inserted] = map.try_emplace(key, 1);
+    ASSERT_TRUE(inserted);
+    ASSERT_FALSE(map.try_emplace("apple", 2).second);
+    ASSERT_TRUE(map.contains(std::string_view("apple")));
+    ASSERT_TRUE(map.contains("apple"));
+    ASSERT_FALSE(map.contains("pear"));
+    ASSERT_EQ(map.find(std::string("apple"))->second, 1);
+}
+
+TEST(FlatHashMapTest, HashSpreadsSimilarStrings) {
+    std::vector<size_t> hashes;
+    FlatHash<std::string> hash;
+    for (const char* word : {"", "a", "b", "ab", "ba", "abcdefghijklmnopq", "abcdefghijklmnopr"}) {
+        hashes.push_back(hash(word));
+    }
+    std::sort(hashes.begin(), hashes.end());
+    ASSERT_EQ(std::adjacent_find(hashes.begin(), hashes.end()), hashes.end());
+    ASSERT_EQ(hash(std::string(100, 'x')), hash(std::string_view(std::string(100, 'x'))));
+}
+
+TEST(FlatHashMapTest, AggregateByStringViewKey) {
+    std::vector<std::string> words = {"to", "be", "or", "not", "to", "be"};
+    auto result =
+        AsDataFlow(words)
+        | AggregateByKey(
+            0,
+            [](const std::string&, int& count) { ++count; },
+            [](const std::string& word) -> std::string_view { return word; })
+        | AsVector();
+
+    ASSERT_THAT(result, testing::ElementsAre(
+        std::make_pair(std::string("to"), 2), std::make_pair(std::string("be"), 2),
+        std::make_pair(std::string("or"), 1), std::make_pair(std::string("not"), 1)));
+}
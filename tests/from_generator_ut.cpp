@@ -0,0 +1,65 @@
+#include <processing.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+Generator<int> Iota(int from, int to) {
+    for (int i = from; i < to; ++i) {
+        co_yield i;
+    }
+}
+
+Generator<std::string> Pages(const std::vector<std::string>& pages) {
+    std::string page;
+    for (const auto& source : pages) {
+        page = source;
+        co_yield page;
+    }
+}
+
+Generator<int> Failing() {
+    co_yield 1;
+    throw std::runtime_error("decoder failed");
+}
+
+}
+
+TEST(FromGeneratorTest, FilterTransform) {
+    auto result = FromGenerator(Iota(0, 10))
+        | Filter([](int x) { return x % 3 == 0; })
+        | Transform([](int x) { return x * 2; })
+        | AsVector();
+    ASSERT_THAT(result, testing::ElementsAre(0, 6, 12, 18));
+}
+
+TEST(FromGeneratorTest, SplitPages) {
+    auto result = FromGenerator(Pages({"a b", "c", "d e f"})) | Split(" ") | AsVector();
+    ASSERT_THAT(result, testing::ElementsAre("a", "b", "c", "d", "e", "f"));
+}
+
+TEST(FromGeneratorTest, YieldsByReference) {
+    std::string value = "original";
+    auto generator = [](std::string& target) -> Generator<std::string> {
+        co_yield target;
+    }(value);
+    for (auto& item : generator) {
+        item = "changed";
+    }
+    ASSERT_EQ(value, "changed");
+}
+
+TEST(FromGeneratorTest, Empty) {
+    auto result = FromGenerator(Iota(5, 5)) | AsVector();
+    ASSERT_TRUE(result.empty());
+}
+
+TEST(FromGeneratorTest, PropagatesExceptions) {
+    auto flow = FromGenerator(Failing());
+    ASSERT_THROW(flow | AsVector(), std::runtime_error);
+}
@@ -0,0 +1,98 @@
+#include <processing.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::filesystem::path SpillParent(const std::string& name) {
+  auto path = std::filesystem::temp_directory_path() / ("ranges_grace_" + name);
+  std::filesystem::create_directories(path);
+  return path;
+}
+
+}
+
+TEST(GraceJoinTest, FitsInBudgetKeepsOrder) {
+  std::vector<KV<int, std::string>> left = {
+      {0, "a"}, {1, "b"}, {2, "c"}, {3, "d"}, {1, "e"}};
+  std::vector<KV<int, std::string>> right = {{0, "f"}, {1, "g"}, {3, "i"}};
+
+  auto result = AsDataFlow(left)
+      | Join(AsDataFlow(right), MemoryBudget{.bytes = 1 << 20})
+      | AsVector();
+
+  ASSERT_THAT(result,
+              testing::ElementsAre(
+                  JoinResult<std::string, std::string>{"a", "f"},
+                  JoinResult<std::string, std::string>{"b", "g"},
+                  JoinResult<std::string, std::string>{"c", std::nullopt},
+                  JoinResult<std::string, std::string>{"d", "i"},
+                  JoinResult<std::string, std::string>{"e", "g"}));
+}
+
+TEST(GraceJoinTest, SpillsAndMatchesInMemoryJoin) {
+  std::vector<KV<int, std::string>> left;
+  std::vector<KV<int, std::string>> right;
+  for (int i = 0; i < 500; ++i) {
+    left.push_back({i % 170, "l" + std::to_string(i)});
+    right.push_back({i % 130, "r" + std::to_string(i)});
+  }
+  auto parent = SpillParent("spill");
+
+  auto expected = AsDataFlow(left) | Join(AsDataFlow(right)) | AsVector();
+  auto result = AsDataFlow(left)
+      | Join(AsDataFlow(right),
+             MemoryBudget{.bytes = 1024, .partitions = 8, .spill_directory = parent})
+      | AsVector();
+
+  ASSERT_EQ(result, expected);
+  ASSERT_TRUE(std::filesystem::is_empty(parent));
+  std::filesystem::remove_all(parent);
+}
+
+TEST(GraceJoinTest, RepartitionsOversizedPartitions) {
+  std::vector<KV<int, std::string>> left;
+  std::vector<KV<int, std::string>> right;
+  for (int i = 0; i < 20000; ++i) {
+    left.push_back({(i * 7) % 9000, "l" + std::to_string(i)});
+    right.push_back({i % 6000, "r" + std::to_string(i)});
+  }
+  right.push_back({42, std::string(5000, 'x')});
+  auto parent = SpillParent("repartition");
+
+  auto expected = AsDataFlow(left) | Join(AsDataFlow(right)) | AsVector();
+  auto result = AsDataFlow(left)
+      | Join(AsDataFlow(right),
+             MemoryBudget{.bytes = 4096, .partitions = 2, .spill_directory = parent})
+      | AsVector();
+
+  ASSERT_EQ(result, expected);
+  ASSERT_TRUE(std::filesystem::is_empty(parent));
+  std::filesystem::remove_all(parent);
+}
+
+TEST(GraceJoinTest, SpillsWithCustomKeys) {
+  std::vector<std::pair<int, int>> left = {{1, 10}, {2, 20}, {3, 30}};
+  std::vector<std::pair<int, int>> right = {{2, 200}, {3, 300}, {3, 301}};
+  auto parent = SpillParent("custom");
+
+  auto result = AsDataFlow(left)
+      | Join(AsDataFlow(right),
+             [](const std::pair<int, int>& row) { return row.first; },
+             [](const std::pair<int, int>& row) { return row.first; },
+             MemoryBudget{.bytes = 1, .partitions = 4, .spill_directory = parent})
+      | AsVector();
+
+  using Row = JoinResult<std::pair<int, int>, std::pair<int, int>>;
+  ASSERT_THAT(result, testing::ElementsAre(
+      Row{{1, 10}, std::nullopt},
+      Row{{2, 20}, std::pair{2, 200}},
+      Row{{3, 30}, std::pair{3, 300}},
+      Row{{3, 30}, std::pair{3, 301}}));
+  std::filesystem::remove_all(parent);
+}
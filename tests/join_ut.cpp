@@ -2,8 +2,10 @@
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <thread>
 #include <vector>
 
 struct Student {
@@ -171,4 +173,97 @@ TEST(JoinTest, ResultOrdering) {
   ASSERT_EQ(result[0].left, "c");
   ASSERT_EQ(result[1].left, "a");
   ASSERT_EQ(result[2].left, "b");
-}
\ No newline at end of file
+}
+
+TEST(JoinTest, DuplicateRightKeysKeepOrder) {
+  std::vector<KV<int, std::string>> left = {{1, "a"}, {2, "b"}};
+  std::vector<KV<int, std::string>> right = {
+      {1, "x"}, {2, "y"}, {1, "z"}, {1, "w"}};
+
+  auto result = AsDataFlow(left) | Join(AsDataFlow(right)) | AsVector();
+
+  ASSERT_THAT(result,
+              testing::ElementsAre(
+                  JoinResult<std::string, std::string>{"a", "x"},
+                  JoinResult<std::string, std::string>{"a", "z"},
+                  JoinResult<std::string, std::string>{"a", "w"},
+                  JoinResult<std::string, std::string>{"b", "y"}));
+}
+
+TEST(JoinTest, FlatIndexManyKeys) {
+  FlatJoinIndex<int, int> index;
+  for (int i = 0; i < 1000; ++i) {
+    index.Add(i % 300, i);
+  }
+  index.Build();
+
+  ASSERT_EQ(index.KeyCount(), 300);
+  ASSERT_EQ(index.ValueCount(), 1000);
+  ASSERT_THAT(index.Find(7), testing::ElementsAre(7, 307, 607, 907));
+  ASSERT_THAT(index.Find(299), testing::ElementsAre(299, 599, 899));
+  ASSERT_TRUE(index.Find(300).empty());
+}
+
+TEST(JoinTest, FlatIndexStridedKeys) {
+  // Keys sharing their low bits must not collapse into one probe chain.
+  FlatJoinIndex<std::int64_t, std::string> index;
+  for (std::int64_t i = 0; i < 40000; ++i) {
+    index.Add(i << 20, std::to_string(i));
+    index.Add(i << 20, std::to_string(-i));
+  }
+  index.Build();
+
+  ASSERT_EQ(index.KeyCount(), 40000);
+  ASSERT_THAT(index.Find(std::int64_t{123} << 20), testing::ElementsAre("123", "-123"));
+  ASSERT_TRUE(index.Find(1).empty());
+}
+
+TEST(JoinTest, SharedIndex) {
+  std::vector<KV<int, std::string>> right = {{0, "f"}, {1, "g"}, {3, "i"}};
+  auto index = BuildJoinIndex(AsDataFlow(right));
+  ASSERT_EQ(index.KeyCount(), 3);
+
+  std::vector<KV<int, std::string>> first = {{0, "a"}, {2, "b"}};
+  std::vector<KV<int, std::string>> second = {{3, "c"}, {1, "d"}};
+
+  ASSERT_THAT(AsDataFlow(first) | Join(index) | AsVector(),
+              testing::ElementsAre(
+                  JoinResult<std::string, std::string>{"a", "f"},
+                  JoinResult<std::string, std::string>{"b", std::nullopt}));
+  ASSERT_THAT(AsDataFlow(second) | Join(index) | AsVector(),
+              testing::ElementsAre(
+                  JoinResult<std::string, std::string>{"c", "i"},
+                  JoinResult<std::string, std::string>{"d", "g"}));
+}
+
+TEST(JoinTest, SharedIndexConcurrentProbes) {
+  std::vector<Group> groups;
+  for (uint64_t i = 0; i < 100; ++i) {
+    groups.push_back({i, "g" + std::to_string(i)});
+  }
+  auto index = BuildJoinIndex(AsDataFlow(groups),
+                              [](const Group &group) { return group.id; });
+
+  std::vector<std::vector<JoinResult<Student, Group>>> results(4);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < results.size(); ++t) {
+    threads.emplace_back([&, t] {
+      std::vector<Student> students;
+      for (uint64_t i = 0; i < 200; ++i) {
+        students.push_back({i + t, "s"});
+      }
+      results[t] = AsDataFlow(students)
+          | Join(index, [](const Student &student) { return student.group_id; })
+          | AsVector();
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (size_t t = 0; t < results.size(); ++t) {
+    ASSERT_EQ(results[t].size(), 200);
+    ASSERT_EQ(results[t][0].right, (Group{t, "g" + std::to_string(t)}));
+    ASSERT_FALSE(results[t][199].right.has_value());
+  }
+}
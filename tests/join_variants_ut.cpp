@@ -0,0 +1,83 @@
+#include <processing.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Row = OuterJoinResult<std::string, std::string>;
+
+std::vector<KV<int, std::string>> Left() {
+  return {{0, "a"}, {1, "b"}, {2, "c"}, {1, "d"}};
+}
+
+std::vector<KV<int, std::string>> Right() {
+  return {{1, "x"}, {3, "y"}, {0, "z"}, {1, "w"}, {4, "v"}};
+}
+
+}
+
+TEST(JoinVariantsTest, Inner) {
+  auto left = Left();
+  auto right = Right();
+  auto result = AsDataFlow(left) | InnerJoin(AsDataFlow(right)) | AsVector();
+
+  ASSERT_THAT(result,
+              testing::ElementsAre(
+                  JoinResult<std::string, std::string>{"a", "z"},
+                  JoinResult<std::string, std::string>{"b", "x"},
+                  JoinResult<std::string, std::string>{"b", "w"},
+                  JoinResult<std::string, std::string>{"d", "x"},
+                  JoinResult<std::string, std::string>{"d", "w"}));
+}
+
+TEST(JoinVariantsTest, Right) {
+  auto left = Left();
+  auto right = Right();
+  auto result = AsDataFlow(left) | RightJoin(AsDataFlow(right)) | AsVector();
+
+  ASSERT_THAT(result,
+              testing::ElementsAre(
+                  Row{"a", "z"}, Row{"b", "x"}, Row{"b", "w"}, Row{"d", "x"},
+                  Row{"d", "w"}, Row{std::nullopt, "y"},
+                  Row{std::nullopt, "v"}));
+}
+
+TEST(JoinVariantsTest, Full) {
+  auto left = Left();
+  auto right = Right();
+  auto result = AsDataFlow(left) | FullJoin(AsDataFlow(right)) | AsVector();
+
+  ASSERT_THAT(result,
+              testing::ElementsAre(
+                  Row{"a", "z"}, Row{"b", "x"}, Row{"b", "w"},
+                  Row{"c", std::nullopt}, Row{"d", "x"}, Row{"d", "w"},
+                  Row{std::nullopt, "y"}, Row{std::nullopt, "v"}));
+}
+
+TEST(JoinVariantsTest, CustomKeys) {
+  std::vector<std::pair<int, char>> left = {{1, 'a'}, {5, 'b'}};
+  std::vector<std::pair<int, char>> right = {{5, 'x'}, {6, 'y'}};
+  auto key = [](const std::pair<int, char>& row) { return row.first; };
+
+  auto result = AsDataFlow(left) | FullJoin(AsDataFlow(right), key, key) | AsVector();
+
+  using Pair = std::pair<int, char>;
+  ASSERT_THAT(result, testing::ElementsAre(
+      OuterJoinResult<Pair, Pair>{Pair{1, 'a'}, std::nullopt},
+      OuterJoinResult<Pair, Pair>{Pair{5, 'b'}, Pair{5, 'x'}},
+      OuterJoinResult<Pair, Pair>{std::nullopt, Pair{6, 'y'}}));
+}
+
+TEST(JoinVariantsTest, EmptySides) {
+  std::vector<KV<int, std::string>> empty;
+  auto right = Right();
+  auto left = Left();
+
+  ASSERT_EQ((AsDataFlow(empty) | RightJoin(AsDataFlow(right)) | AsVector()).size(), 5);
+  ASSERT_EQ((AsDataFlow(left) | FullJoin(AsDataFlow(empty)) | AsVector()).size(), 4);
+  ASSERT_TRUE((AsDataFlow(left) | InnerJoin(AsDataFlow(empty)) | AsVector()).empty());
+}
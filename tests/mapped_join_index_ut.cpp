@@ -0,0 +1,93 @@
+#include <processing.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::filesystem::path TempPath(const std::string& name) {
+  return std::filesystem::temp_directory_path() / ("ranges_index_" + name);
+}
+
+}
+
+TEST(MappedJoinIndexTest, MatchesInMemoryJoin) {
+  std::vector<KV<std::string, std::string>> right = {
+      {"apple", "red"}, {"banana", "yellow"}, {"apple", "green"}, {"", "none"}};
+  std::vector<KV<std::string, int>> left = {
+      {"apple", 1}, {"cherry", 2}, {"banana", 3}, {"", 4}};
+  auto path = TempPath("strings.bin");
+
+  SaveJoinIndex(BuildJoinIndex(AsDataFlow(right)), path);
+  MappedJoinIndex<std::string, std::string> index(path);
+
+  ASSERT_EQ(index.KeyCount(), 3);
+  ASSERT_EQ(index.ValueCount(), 4);
+  ASSERT_THAT(AsDataFlow(left) | Join(index) | AsVector(),
+              testing::ElementsAre(
+                  JoinResult<int, std::string>{1, "red"},
+                  JoinResult<int, std::string>{1, "green"},
+                  JoinResult<int, std::string>{2, std::nullopt},
+                  JoinResult<int, std::string>{3, "yellow"},
+                  JoinResult<int, std::string>{4, "none"}));
+  std::filesystem::remove(path);
+}
+
+TEST(MappedJoinIndexTest, ManyIntegerKeys) {
+  std::vector<std::pair<int, double>> right;
+  for (int i = 0; i < 2000; ++i) {
+    right.push_back({i % 700, i * 0.5});
+  }
+  auto path = TempPath("ints.bin");
+  SaveJoinIndex(BuildJoinIndex(AsDataFlow(right),
+                               [](const std::pair<int, double>& row) { return row.first; }),
+                path);
+
+  MappedJoinIndex<int, std::pair<int, double>> index(path);
+  auto matches = index.Find(5);
+  ASSERT_EQ(matches.size(), 3);
+  ASSERT_EQ(matches[0], std::make_pair(5, 2.5));
+  ASSERT_EQ(matches[2], std::make_pair(5, 702.5));
+  ASSERT_TRUE(index.Find(700).empty());
+
+  std::vector<int> left = {699, 1000};
+  auto result = AsDataFlow(left) | Join(index, [](int key) { return key; }) | AsVector();
+  ASSERT_EQ(result.size(), 3);
+  ASSERT_FALSE(result[2].right.has_value());
+  std::filesystem::remove(path);
+}
+
+TEST(MappedJoinIndexTest, SignedZeroKeys) {
+  std::vector<KV<double, int>> right = {{-0.0, 1}, {2.5, 2}};
+  auto path = TempPath("doubles.bin");
+
+  SaveJoinIndex(BuildJoinIndex(AsDataFlow(right)), path);
+  MappedJoinIndex<double, int> index(path);
+
+  auto matches = index.Find(0.0);
+  ASSERT_EQ(matches.size(), 1);
+  ASSERT_EQ(matches[0], 1);
+  ASSERT_EQ(index.Find(2.5).size(), 1);
+  std::filesystem::remove(path);
+}
+
+TEST(MappedJoinIndexTest, EmptyIndex) {
+  std::vector<KV<int, int>> right;
+  auto path = TempPath("empty.bin");
+  SaveJoinIndex(BuildJoinIndex(AsDataFlow(right)), path);
+  MappedJoinIndex<int, int> index(path);
+  ASSERT_TRUE(index.Find(1).empty());
+  std::filesystem::remove(path);
+}
+
+TEST(MappedJoinIndexTest, RejectsOtherFiles) {
+  std::vector<int> input = {1, 2, 3};
+  auto path = TempPath("materialized.bin");
+  AsDataFlow(input) | Materialize(path);
+  ASSERT_THROW((MappedJoinIndex<int, int>(path)), std::runtime_error);
+  std::filesystem::remove(path);
+}
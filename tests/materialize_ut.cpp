@@ -0,0 +1,85 @@
+#include <processing.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+
+std::filesystem::path TempPath(const std::string& name) {
+    return std::filesystem::temp_directory_path() / ("ranges_materialize_" + name);
+}
+
+}
+
+TEST(MaterializeTest, Integers) {
+    std::vector<int> input = {1, 2, 3, 4, 5};
+    auto path = TempPath("ints.bin");
+    auto result = AsDataFlow(input) | Materialize(path) | AsVector();
+    ASSERT_THAT(result, testing::ElementsAre(1, 2, 3, 4, 5));
+    std::filesystem::remove(path);
+}
+
+TEST(MaterializeTest, ReuseTokenizedCorpus) {
+    std::vector<std::stringstream> files(2);
+    files[0] << "a b c";
+    files[1] << "d e";
+    auto path = TempPath("tokens.bin");
+    AsDataFlow(files) | Split(" ") | Materialize(path);
+
+    auto first = FromMaterialized<std::string>(path) | AsVector();
+    auto second = FromMaterialized<std::string>(path)
+        | Filter([](const std::string& token) { return token != "c"; })
+        | AsVector();
+
+    ASSERT_THAT(first, testing::ElementsAre("a", "b", "c", "d", "e"));
+    ASSERT_THAT(second, testing::ElementsAre("a", "b", "d", "e"));
+    ASSERT_EQ(FromMaterialized<std::string>(path).size(), 5);
+    std::filesystem::remove(path);
+}
+
+TEST(MaterializeTest, AggregatedPairs) {
+    std::vector<std::pair<std::string, size_t>> input = {
+        {"apple", 3}, {"", 0}, {std::string(300, 'x'), 42}};
+    auto path = TempPath("pairs.bin");
+    AsDataFlow(input) | Materialize(path);
+    auto result = FromMaterialized<std::pair<std::string, size_t>>(path) | AsVector();
+    ASSERT_EQ(result, input);
+    std::filesystem::remove(path);
+}
+
+TEST(MaterializeTest, KeyValue) {
+    std::vector<KV<int, std::string>> input = {{0, "a"}, {1, "bb"}};
+    auto path = TempPath("kv.bin");
+    auto result = AsDataFlow(input) | Materialize(path) | AsVector();
+    ASSERT_EQ(result.size(), 2);
+    ASSERT_EQ(result[0].key, 0);
+    ASSERT_EQ(result[0].value, "a");
+    ASSERT_EQ(result[1].key, 1);
+    ASSERT_EQ(result[1].value, "bb");
+    std::filesystem::remove(path);
+}
+
+TEST(MaterializeTest, Empty) {
+    std::vector<double> input;
+    auto path = TempPath("empty.bin");
+    auto result = AsDataFlow(input) | Materialize(path) | AsVector();
+    ASSERT_TRUE(result.empty());
+    std::filesystem::remove(path);
+}
+
+TEST(MaterializeTest, MissingFile) {
+    ASSERT_THROW(FromMaterialized<int>(TempPath("missing.bin")), std::runtime_error);
+}
+
+TEST(MaterializeTest, RejectsPointerLikeTypes) {
+    static_assert(IsMaterializeRaw<double>::value);
+    static_assert(!IsMaterializeRaw<std::string_view>::value);
+    static_assert(!IsMaterializeRaw<const char*>::value);
+    static_assert(!IsMaterializeRaw<std::pair<int, int>*>::value);
+}
@@ -0,0 +1,84 @@
+#include <processing.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <memory_resource>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+class CountingResource : public std::pmr::memory_resource {
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream) : upstream_(upstream) {}
+
+    size_t allocations() const { return allocations_; }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++allocations_;
+        return upstream_->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        upstream_->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource* upstream_;
+    size_t allocations_ = 0;
+};
+
+}
+
+TEST(MemoryResourceTest, SplitTokensFromArena) {
+    std::pmr::monotonic_buffer_resource arena;
+    CountingResource counting(&arena);
+
+    std::vector<std::stringstream> files(1);
+    files[0] << "a-rather-long-token-that-does-not-fit-sso,b,c";
+    auto result = AsDataFlow(files) | Split(",", &counting) | AsVector(&counting);
+
+    ASSERT_TRUE((std::is_same_v<decltype(result), std::pmr::vector<std::pmr::string>>));
+    ASSERT_THAT(result, testing::ElementsAre("a-rather-long-token-that-does-not-fit-sso", "b", "c"));
+    ASSERT_EQ(result.get_allocator().resource(), &counting);
+    ASSERT_EQ(result[0].get_allocator().resource(), &counting);
+    ASSERT_GT(counting.allocations(), 0);
+}
+
+TEST(MemoryResourceTest, AggregateByKeyTableFromArena) {
+    std::pmr::monotonic_buffer_resource arena;
+    CountingResource counting(&arena);
+
+    std::vector<int> input = {1, 2, 1, 3, 1};
+    auto result = AsDataFlow(input)
+        | AggregateByKey(
+            0,
+            [](int, int& acc) { ++acc; },
+            [](int x) { return x; },
+            &counting)
+        | AsVector();
+
+    ASSERT_THAT(result, testing::UnorderedElementsAre(
+        std::make_pair(1, 3), std::make_pair(2, 1), std::make_pair(3, 1)));
+    ASSERT_GT(counting.allocations(), 0);
+}
+
+TEST(MemoryResourceTest, JoinIndexFromArena) {
+    std::pmr::monotonic_buffer_resource arena;
+    CountingResource counting(&arena);
+
+    std::vector<KV<int, std::string>> left = {{0, "a"}, {1, "b"}};
+    std::vector<KV<int, std::string>> right = {{0, "f"}};
+    auto result = AsDataFlow(left) | Join(AsDataFlow(right), &counting) | AsVector();
+
+    ASSERT_THAT(result, testing::ElementsAre(
+        JoinResult<std::string, std::string>{"a", "f"},
+        JoinResult<std::string, std::string>{"b", std::nullopt}));
+    ASSERT_GT(counting.allocations(), 0);
+}
@@ -0,0 +1,87 @@
+#include <processing.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <optional>
+#include <string>
+#include <vector>
+
+TEST(MergeJoinTest, MatchesHashJoin) {
+  std::vector<KV<int, std::string>> left = {
+      {0, "a"}, {1, "b"}, {1, "e"}, {2, "c"}, {3, "d"}};
+  std::vector<KV<int, std::string>> right = {{0, "f"}, {1, "g"}, {3, "i"}};
+
+  auto merged = AsDataFlow(left) | MergeJoin(AsDataFlow(right)) | AsVector();
+  auto hashed = AsDataFlow(left) | Join(AsDataFlow(right)) | AsVector();
+
+  ASSERT_EQ(merged, hashed);
+  ASSERT_THAT(merged,
+              testing::ElementsAre(
+                  JoinResult<std::string, std::string>{"a", "f"},
+                  JoinResult<std::string, std::string>{"b", "g"},
+                  JoinResult<std::string, std::string>{"e", "g"},
+                  JoinResult<std::string, std::string>{"c", std::nullopt},
+                  JoinResult<std::string, std::string>{"d", "i"}));
+}
+
+TEST(MergeJoinTest, DuplicateGroupsOnBothSides) {
+  std::vector<KV<int, std::string>> left = {{1, "a"}, {1, "b"}, {4, "c"}};
+  std::vector<KV<int, std::string>> right = {
+      {0, "x"}, {1, "p"}, {1, "q"}, {2, "y"}, {4, "r"}, {5, "z"}};
+
+  auto result = AsDataFlow(left) | MergeJoin(AsDataFlow(right)) | AsVector();
+
+  ASSERT_THAT(result,
+              testing::ElementsAre(
+                  JoinResult<std::string, std::string>{"a", "p"},
+                  JoinResult<std::string, std::string>{"a", "q"},
+                  JoinResult<std::string, std::string>{"b", "p"},
+                  JoinResult<std::string, std::string>{"b", "q"},
+                  JoinResult<std::string, std::string>{"c", "r"}));
+}
+
+TEST(MergeJoinTest, CustomExtractors) {
+  struct Order {
+    int customer;
+    int amount;
+    bool operator==(const Order &other) const = default;
+  };
+  struct Customer {
+    int id;
+    std::string name;
+    bool operator==(const Customer &other) const = default;
+  };
+  std::vector<Order> orders = {{1, 10}, {2, 20}, {2, 30}};
+  std::vector<Customer> customers = {{2, "bob"}, {3, "eve"}};
+
+  auto result = AsDataFlow(orders)
+      | MergeJoin(AsDataFlow(customers),
+                  [](const Order &order) { return order.customer; },
+                  [](const Customer &customer) { return customer.id; })
+      | AsVector();
+
+  ASSERT_THAT(result,
+              testing::ElementsAre(
+                  JoinResult<Order, Customer>{Order{1, 10}, std::nullopt},
+                  JoinResult<Order, Customer>{Order{2, 20}, Customer{2, "bob"}},
+                  JoinResult<Order, Customer>{Order{2, 30}, Customer{2, "bob"}}));
+}
+
+TEST(MergeJoinTest, EmptyRight) {
+  std::vector<KV<int, std::string>> left = {{1, "a"}};
+  std::vector<KV<int, std::string>> right;
+
+  auto result = AsDataFlow(left) | MergeJoin(AsDataFlow(right)) | AsVector();
+
+  ASSERT_THAT(result, testing::ElementsAre(
+      JoinResult<std::string, std::string>{"a", std::nullopt}));
+}
+
+TEST(MergeJoinDeathTest, UnsortedInput) {
+  std::vector<KV<int, std::string>> left = {{0, "a"}, {5, "b"}};
+  std::vector<KV<int, std::string>> right = {{3, "x"}, {1, "y"}, {5, "z"}};
+
+  EXPECT_DEBUG_DEATH(
+      AsDataFlow(left) | MergeJoin(AsDataFlow(right)) | AsVector(),
+      "not sorted");
+}
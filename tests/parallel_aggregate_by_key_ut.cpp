@@ -0,0 +1,68 @@
+#include <processing.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+TEST(ParallelAggregateByKeyTest, MatchesSerial) {
+    std::vector<std::string> words;
+    for (int i = 0; i < 50000; ++i) {
+        words.push_back("w" + std::to_string(i * 31 % 997));
+    }
+
+    auto count = [](const std::string&, size_t& acc) { ++acc; };
+    auto key = [](const std::string& word) { return word; };
+
+    auto serial = AsDataFlow(words) | AggregateByKey(0uz, count, key) | AsVector();
+    auto parallel =
+        AsDataFlow(words)
+        | ParallelAggregateByKey(
+            0uz, count, key,
+            [](size_t& acc, size_t other) { acc += other; },
+            4)
+        | AsVector();
+
+    ASSERT_EQ(parallel, serial);
+}
+
+TEST(ParallelAggregateByKeyTest, VectorAccumulator) {
+    std::vector<int> input;
+    for (int i = 0; i < 10000; ++i) {
+        input.push_back(i);
+    }
+
+    auto result =
+        AsDataFlow(input)
+        | ParallelAggregateByKey(
+            std::vector<int>{},
+            [](int x, std::vector<int>& acc) { acc.push_back(x); },
+            [](int x) { return x % 3; },
+            [](std::vector<int>& acc, std::vector<int>&& other) {
+                acc.insert(acc.end(), other.begin(), other.end());
+            },
+            3);
+
+    ASSERT_EQ(result.size(), 3);
+    for (int remainder = 0; remainder < 3; ++remainder) {
+        ASSERT_EQ(result[remainder].first, remainder);
+        auto values = result[remainder].second;
+        std::sort(values.begin(), values.end());
+        ASSERT_EQ(values.size(), remainder == 0 ? 3334 : 3333);
+        ASSERT_EQ(values.front(), remainder);
+    }
+}
+
+TEST(ParallelAggregateByKeyTest, EmptyInput) {
+    std::vector<int> input;
+    auto result =
+        AsDataFlow(input)
+        | ParallelAggregateByKey(
+            0,
+            [](int, int& acc) { ++acc; },
+            [](int x) { return x; },
+            [](int& acc, int other) { acc += other; });
+    ASSERT_TRUE(result.empty());
+}
@@ -0,0 +1,71 @@
+#include <processing.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+std::vector<KV<int, std::string>> MakeRows(int count, int modulo, const std::string& prefix) {
+  std::vector<KV<int, std::string>> rows;
+  for (int i = 0; i < count; ++i) {
+    rows.push_back({i % modulo, prefix + std::to_string(i)});
+  }
+  return rows;
+}
+
+}
+
+TEST(ParallelJoinTest, OrderedMatchesJoin) {
+  auto left = MakeRows(5000, 700, "l");
+  auto right = MakeRows(1000, 500, "r");
+
+  auto expected = AsDataFlow(left) | Join(AsDataFlow(right)) | AsVector();
+  auto result = AsDataFlow(left)
+      | Join(AsDataFlow(right), JoinParallelism{.threads = 4, .batch_size = 64})
+      | AsVector();
+
+  ASSERT_EQ(result, expected);
+}
+
+TEST(ParallelJoinTest, UnorderedHasSameRows) {
+  auto left = MakeRows(3000, 400, "l");
+  auto right = MakeRows(800, 300, "r");
+
+  auto expected = AsDataFlow(left) | Join(AsDataFlow(right)) | AsVector();
+  auto result = AsDataFlow(left)
+      | Join(AsDataFlow(right),
+             JoinParallelism{.threads = 3, .ordered = false, .batch_size = 100})
+      | AsVector();
+
+  auto by_row = [](const auto& lhs, const auto& rhs) {
+    return std::tie(lhs.left, lhs.right) < std::tie(rhs.left, rhs.right);
+  };
+  std::sort(result.begin(), result.end(), by_row);
+  std::sort(expected.begin(), expected.end(), by_row);
+  ASSERT_EQ(result, expected);
+}
+
+TEST(ParallelJoinTest, CustomKeys) {
+  struct Row {
+    int id;
+    std::string name;
+    bool operator==(const Row& other) const = default;
+  };
+  std::vector<Row> left = {{1, "a"}, {2, "b"}, {3, "c"}};
+  std::vector<Row> right = {{3, "x"}, {1, "y"}};
+
+  auto result = AsDataFlow(left)
+      | Join(AsDataFlow(right), [](const Row& row) { return row.id; },
+             [](const Row& row) { return row.id; }, JoinParallelism{.threads = 2})
+      | AsVector();
+
+  ASSERT_THAT(result, testing::ElementsAre(
+      JoinResult<Row, Row>{Row{1, "a"}, Row{1, "y"}},
+      JoinResult<Row, Row>{Row{2, "b"}, std::nullopt},
+      JoinResult<Row, Row>{Row{3, "c"}, Row{3, "x"}}));
+}
@@ -0,0 +1,94 @@
+#include <processing.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::filesystem::path TempDir(const std::string& name) {
+    return std::filesystem::temp_directory_path() / ("ranges_partition_" + name);
+}
+
+}
+
+TEST(PartitionByTest, EveryElementOnce) {
+    std::vector<int> input;
+    for (int i = 0; i < 1000; ++i) {
+        input.push_back(i);
+    }
+    auto dir = TempDir("ints");
+    auto partitions = AsDataFlow(input) | PartitionBy([](int x) { return x; }, 4, dir);
+
+    ASSERT_EQ(partitions.size(), 4);
+    std::multiset<int> seen;
+    for (const auto& partition : partitions) {
+        for (int value : partition) {
+            seen.insert(value);
+        }
+    }
+    ASSERT_EQ(seen, std::multiset<int>(input.begin(), input.end()));
+    std::filesystem::remove_all(dir);
+}
+
+TEST(PartitionByTest, EqualKeysTogether) {
+    std::vector<KV<std::string, int>> input = {
+        {"a", 1}, {"b", 2}, {"a", 3}, {"c", 4}, {"b", 5}, {"a", 6}};
+    auto dir = TempDir("kv");
+    auto partitions = AsDataFlow(input)
+        | PartitionBy([](const KV<std::string, int>& kv) { return kv.key; }, 3, dir);
+
+    size_t total = 0;
+    std::set<std::string> owners[3];
+    for (size_t i = 0; i < partitions.size(); ++i) {
+        auto sums = partitions[i]
+            | AggregateByKey(
+                0,
+                [](const KV<std::string, int>& kv, int& sum) { sum += kv.value; },
+                [](const KV<std::string, int>& kv) { return kv.key; })
+            | AsVector();
+        for (const auto& [key, sum] : sums) {
+            owners[i].insert(key);
+            total += sum;
+        }
+    }
+    ASSERT_EQ(total, 21);
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = i + 1; j < 3; ++j) {
+            for (const auto& key : owners[i]) {
+                ASSERT_FALSE(owners[j].contains(key));
+            }
+        }
+    }
+    std::filesystem::remove_all(dir);
+}
+
+TEST(PartitionByTest, StridedKeysBalanced) {
+    std::vector<int> input;
+    for (int i = 0; i < 8000; ++i) {
+        input.push_back(i * 8);
+    }
+    auto dir = TempDir("strided");
+    auto partitions = AsDataFlow(input) | PartitionBy([](int x) { return x; }, 8, dir);
+
+    ASSERT_EQ(partitions.size(), 8);
+    for (const auto& partition : partitions) {
+        EXPECT_GT(partition.size(), 800);
+        EXPECT_LT(partition.size(), 1200);
+    }
+    std::filesystem::remove_all(dir);
+}
+
+TEST(PartitionByTest, EmptyInput) {
+    std::vector<int> input;
+    auto dir = TempDir("empty");
+    auto partitions = AsDataFlow(input) | PartitionBy([](int x) { return x; }, 2, dir);
+    ASSERT_EQ(partitions.size(), 2);
+    ASSERT_EQ(partitions[0].size(), 0);
+    ASSERT_EQ(partitions[1].size(), 0);
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,59 @@
+#include <processing.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <list>
+#include <optional>
+#include <sstream>
+#include <vector>
+
+TEST(SizeHintTest, ExactForContainers) {
+    std::vector<int> input = {1, 2, 3};
+    auto hint = GetSizeHint(AsDataFlow(input));
+    ASSERT_TRUE(hint.has_value());
+    ASSERT_EQ(hint->value, 3);
+    ASSERT_TRUE(hint->exact);
+}
+
+TEST(SizeHintTest, ExactThroughTransform) {
+    std::list<int> input = {1, 2, 3, 4};
+    auto flow = AsDataFlow(input) | Transform([](int x) { return x * 2; });
+    auto hint = GetSizeHint(flow);
+    ASSERT_TRUE(hint.has_value());
+    ASSERT_EQ(hint->value, 4);
+    ASSERT_TRUE(hint->exact);
+}
+
+TEST(SizeHintTest, UpperBoundThroughFilter) {
+    std::vector<std::optional<int>> input = {1, std::nullopt, 3};
+    auto flow = AsDataFlow(input)
+        | DropNullopt()
+        | Filter([](int x) { return x > 1; })
+        | Transform([](int x) { return x + 1; });
+    auto hint = GetSizeHint(flow);
+    ASSERT_TRUE(hint.has_value());
+    ASSERT_EQ(hint->value, 3);
+    ASSERT_FALSE(hint->exact);
+}
+
+TEST(SizeHintTest, NoneForSplit) {
+    std::vector<std::stringstream> files(1);
+    files[0] << "a b c";
+    auto flow = AsDataFlow(files) | Split(" ");
+    ASSERT_FALSE(GetSizeHint(flow).has_value());
+}
+
+TEST(SizeHintTest, AsVectorReserves) {
+    std::vector<int> input(1000, 7);
+    auto result = AsDataFlow(input) | Transform([](int x) { return x + 1; }) | AsVector();
+    ASSERT_EQ(result.size(), 1000);
+    ASSERT_EQ(result.capacity(), 1000);
+}
+
+TEST(SizeHintTest, AsVectorIgnoresUpperBound) {
+    std::vector<int> input(1000, 7);
+    auto result = AsDataFlow(input) | Filter([](int x) { return x > 7; }) | AsVector();
+    ASSERT_TRUE(result.empty());
+    ASSERT_EQ(result.capacity(), 0);
+}
@@ -4,6 +4,7 @@
 #include <gtest/gtest.h>
 
 #include <expected>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -25,6 +26,13 @@ std::expected<Department, std::string> ParseDepartment(const std::string& str) {
     return Department{str};
 }
 
+struct ThrowingSink {};
+
+template <typename Range>
+int operator|(Range&&, const ThrowingSink&) {
+    throw std::runtime_error("sink failure");
+}
+
 std::expected<int, std::string> ParseInteger(const std::string& str) {
     try {
         return std::stoi(str);
@@ -150,4 +158,64 @@ TEST(SplitExpectedTest, CustomTransformerTest) {
 
     ASSERT_EQ(unexpected_file.str(), "Number must be positive Parsing error Parsing error ");
     ASSERT_THAT(expected_result, testing::ElementsAre(10, 15));
-}
\ No newline at end of file
+}
+
+TEST(SplitExpectedTest, RouteSinglePass) {
+    std::vector<std::stringstream> files(1);
+    files[0] << "123,abc,456,9999999999999999999,0,-42";
+
+    int parses = 0;
+    auto counting_parser = [&parses](const std::string& str) {
+        ++parses;
+        return ParseInteger(str);
+    };
+
+    std::stringstream unexpected_file;
+    auto [expected_result, write_proxy] =
+        AsDataFlow(files) | Split(",") | Transform(counting_parser) | SplitExpected(ParseInteger)
+        | Route(AsVector(), Write(unexpected_file, '|'));
+
+    ASSERT_THAT(expected_result, testing::ElementsAre(123, 456, 0, -42));
+    ASSERT_EQ(unexpected_file.str(), "Invalid number format|Number out of range|");
+    ASSERT_EQ(parses, 6);
+}
+
+TEST(SplitExpectedTest, RouteWithSmallBuffer) {
+    std::vector<std::string> input;
+    for (int i = 0; i < 1000; ++i) {
+        input.push_back(i % 3 == 0 ? "x" : std::to_string(i));
+    }
+
+    auto [good, bad] =
+        AsDataFlow(input) | Transform(ParseInteger) | SplitExpected(ParseInteger)
+        | Route(AsVector(), AsVector(), 4);
+
+    ASSERT_EQ(good.size(), 666);
+    ASSERT_EQ(bad.size(), 334);
+    ASSERT_EQ(good.front(), 1);
+    ASSERT_EQ(bad.front(), "Invalid number format");
+}
+
+TEST(SplitExpectedTest, RouteRethrowsUpstreamError) {
+    std::vector<std::string> input = {"1", "x", "boom", "2"};
+    auto throwing_parser = [](const std::string& str) {
+        if (str == "boom") {
+            throw std::runtime_error("upstream failure");
+        }
+        return ParseInteger(str);
+    };
+
+    ASSERT_THROW(
+        AsDataFlow(input) | Transform(throwing_parser) | SplitExpected(ParseInteger)
+        | Route(AsVector(), AsVector(), 2),
+        std::runtime_error);
+}
+
+TEST(SplitExpectedTest, RouteStopsAfterSinkFailure) {
+    std::vector<std::string> input(100000, "1");
+    size_t pulled = 0;
+    auto counted = AsDataFlow(input) | Transform([&pulled](const std::string& str) { ++pulled; return ParseInteger(str); });
+
+    ASSERT_THROW(counted | SplitExpected(ParseInteger) | Route(ThrowingSink{}, AsVector(), 16), std::runtime_error);
+    ASSERT_LT(pulled, input.size());
+}
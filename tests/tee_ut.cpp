@@ -0,0 +1,102 @@
+#include <processing.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct ThrowingSink {};
+
+template <typename Range>
+int operator|(Range&&, const ThrowingSink&) {
+    throw std::runtime_error("sink failure");
+}
+
+}
+
+TEST(TeeTest, SeveralSinksOnePass) {
+    std::vector<std::stringstream> files(1);
+    files[0] << "b a b c b";
+
+    int splits = 0;
+    std::stringstream dump;
+    auto [tokens, counts, written] =
+        AsDataFlow(files)
+        | Split(" ")
+        | Transform([&splits](const std::string& token) { ++splits; return token; })
+        | Tee(
+            AsVector(),
+            AggregateByKey(
+                0uz,
+                [](const std::string&, size_t& count) { ++count; },
+                [](const std::string& token) { return token; }),
+            Write(dump, ','));
+
+    ASSERT_THAT(tokens, testing::ElementsAre("b", "a", "b", "c", "b"));
+    ASSERT_THAT(counts, testing::UnorderedElementsAre(
+        std::make_pair("a", 1), std::make_pair("b", 3), std::make_pair("c", 1)));
+    ASSERT_EQ(dump.str(), "b,a,b,c,b,");
+    ASSERT_EQ(splits, 5);
+}
+
+TEST(TeeTest, QueuedBranches) {
+    std::vector<int> input;
+    for (int i = 0; i < 5000; ++i) {
+        input.push_back(i);
+    }
+
+    int reads = 0;
+    auto [all, parity] =
+        AsDataFlow(input)
+        | Transform([&reads](int x) { ++reads; return x; })
+        | Tee(
+            TeeQueue{8},
+            AsVector(),
+            AggregateByKey(
+                0,
+                [](int x, int& sum) { sum += x; },
+                [](int x) { return x % 2; }));
+
+    ASSERT_EQ(all.size(), 5000);
+    ASSERT_EQ(reads, 5000);
+    ASSERT_EQ(all.back(), 4999);
+    ASSERT_THAT(parity, testing::UnorderedElementsAre(
+        std::make_pair(0, 6247500), std::make_pair(1, 6250000)));
+}
+
+TEST(TeeTest, QueuedWithWrite) {
+    std::vector<int> input = {1, 2, 3};
+    std::stringstream first;
+    std::stringstream second;
+    AsDataFlow(input) | Tee(TeeQueue{2}, Write(first, ' '), Write(second, '|'));
+    ASSERT_EQ(first.str(), "1 2 3 ");
+    ASSERT_EQ(second.str(), "1|2|3|");
+}
+
+TEST(TeeTest, Empty) {
+    std::vector<int> input;
+    auto [first, second] = AsDataFlow(input) | Tee(AsVector(), AsVector());
+    ASSERT_TRUE(first.empty());
+    ASSERT_TRUE(second.empty());
+}
+
+TEST(TeeTest, BufferedOnCallingThread) {
+    std::vector<int> input = {3, 1, 2};
+    std::stringstream dump;
+    auto [values, written] = AsDataFlow(input) | Tee(TeeBuffer{}, AsVector(), Write(dump, ' '));
+    ASSERT_THAT(values, testing::ElementsAre(3, 1, 2));
+    ASSERT_EQ(dump.str(), "3 1 2 ");
+}
+
+TEST(TeeTest, FailingSinkStopsUpstream) {
+    std::vector<int> input(100000, 1);
+    size_t pulled = 0;
+    auto counted = AsDataFlow(input) | Transform([&pulled](int x) { ++pulled; return x; });
+    ASSERT_THROW(counted | Tee(TeeQueue{.capacity = 16}, AsVector(), ThrowingSink{}), std::runtime_error);
+    ASSERT_LT(pulled, input.size());
+}
@@ -0,0 +1,19 @@
+#include <processing.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <future>
+#include <vector>
+
+TEST(ThreadPoolTest, RunsSubmittedTasks) {
+  ThreadPool pool(4);
+  std::vector<std::future<int>> results;
+  for (int i = 0; i < 100; ++i) {
+    results.push_back(pool.Submit([i] { return i * i; }));
+  }
+  int sum = 0;
+  for (auto& result : results) {
+    sum += result.get();
+  }
+  ASSERT_EQ(sum, 328350);
+}
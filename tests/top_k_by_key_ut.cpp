@@ -0,0 +1,128 @@
+#include <processing.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Key i occurs 1000 / i times, followed by a long tail of unique keys.
+std::vector<std::string> SkewedWords() {
+    std::vector<std::string> words;
+    for (int round = 0; round < 1000; ++round) {
+        for (int i = 1; i <= 50; ++i) {
+            if (round % i == 0) {
+                words.push_back("hot" + std::to_string(i));
+            }
+        }
+        words.push_back("cold" + std::to_string(round));
+    }
+    return words;
+}
+
+std::map<std::string, size_t> ExactCounts(const std::vector<std::string>& words) {
+    std::map<std::string, size_t> counts;
+    for (const auto& word : words) {
+        ++counts[word];
+    }
+    return counts;
+}
+
+void ExpectBounds(const std::vector<HeavyHitter<std::string>>& top,
+                  const std::map<std::string, size_t>& exact) {
+    for (const auto& hitter : top) {
+        size_t count = exact.at(hitter.key);
+        EXPECT_LE(hitter.count - hitter.error, count) << hitter.key;
+        EXPECT_GE(hitter.count, count) << hitter.key;
+    }
+}
+
+auto Identity() {
+    return [](const std::string& word) -> const std::string& { return word; };
+}
+
+}
+
+TEST(TopKByKeyTest, FindsHeavyHitters) {
+    auto words = SkewedWords();
+    auto summary = AsDataFlow(words) | TopKByKey(20, Identity());
+    auto top = summary.Top();
+
+    ASSERT_EQ(top.size(), 20);
+    ASSERT_EQ(summary.Total(), words.size());
+    EXPECT_EQ(top[0].key, "hot1");
+    EXPECT_EQ(top[1].key, "hot2");
+    EXPECT_EQ(top[2].key, "hot3");
+    ExpectBounds(top, ExactCounts(words));
+}
+
+TEST(TopKByKeyTest, ExactBelowCapacity) {
+    std::vector<std::string> words = {"a", "b", "a", "c", "a", "b"};
+    auto top = (AsDataFlow(words) | TopKByKey(10, Identity())).Top();
+    ASSERT_THAT(top, testing::ElementsAre(
+        HeavyHitter<std::string>{"a", 3, 0},
+        HeavyHitter<std::string>{"b", 2, 0},
+        HeavyHitter<std::string>{"c", 1, 0}));
+}
+
+TEST(TopKByKeyTest, CountMinTightensBounds) {
+    auto words = SkewedWords();
+    auto plain = AsDataFlow(words) | TopKByKey(20, Identity());
+    auto sketched = AsDataFlow(words) | TopKByKey(20, Identity(), CountMinOptions{.width = 4096, .depth = 4});
+    auto exact = ExactCounts(words);
+
+    ExpectBounds(sketched.Top(), exact);
+    size_t plain_error = 0;
+    for (const auto& hitter : plain.Top()) {
+        plain_error += hitter.error;
+    }
+    size_t sketched_error = 0;
+    for (const auto& hitter : sketched.Top()) {
+        sketched_error += hitter.error;
+    }
+    EXPECT_LT(sketched_error, plain_error);
+    EXPECT_GE(sketched.Estimate(std::string("cold7")), 1);
+    EXPECT_LE(sketched.Estimate(std::string("cold7")), plain.Estimate(std::string("cold7")));
+}
+
+TEST(TopKByKeyTest, ReadmittedKeyKeepsBounds) {
+    std::vector<std::string> words(10, "a");
+    words.push_back("b");
+    words.push_back("a");
+
+    auto plain = AsDataFlow(words) | TopKByKey(1, Identity());
+    auto sketched = AsDataFlow(words) | TopKByKey(1, Identity(), CountMinOptions{});
+    ExpectBounds(plain.Top(), ExactCounts(words));
+    ExpectBounds(sketched.Top(), ExactCounts(words));
+    EXPECT_GE(plain.Top()[0].count, 11);
+    EXPECT_GE(sketched.Top()[0].count, 11);
+
+    words.pop_back();
+    auto evicted = AsDataFlow(words) | TopKByKey(1, Identity(), CountMinOptions{});
+    EXPECT_GE(evicted.Estimate(std::string("a")), 10);
+}
+
+TEST(TopKByKeyTest, MergedPartialsCoverWholeInput) {
+    auto words = SkewedWords();
+    std::vector<std::string> first(words.begin(), words.begin() + words.size() / 2);
+    std::vector<std::string> second(words.begin() + words.size() / 2, words.end());
+
+    auto merged = AsDataFlow(first) | TopKByKey(20, Identity());
+    merged.Merge(AsDataFlow(second) | TopKByKey(20, Identity()));
+    auto top = merged.Top();
+
+    ASSERT_EQ(top.size(), 20);
+    ASSERT_EQ(merged.Total(), words.size());
+    EXPECT_EQ(top[0].key, "hot1");
+    EXPECT_EQ(top[1].key, "hot2");
+    ExpectBounds(top, ExactCounts(words));
+}
+
+TEST(TopKByKeyTest, MergeRejectsDifferentShapes) {
+    SpaceSaving<int> plain(4);
+    SpaceSaving<int> sketched(4, CountMinOptions{});
+    ASSERT_THROW(plain.Merge(sketched), std::invalid_argument);
+}
@@ -3,6 +3,9 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <list>
+
 TEST(TransformTest, PowerOfTwo) {
     std::vector<int> input = {1, 2, 3, 4, 5};
     auto result = AsDataFlow(input) | Transform([](int x) { return x * x; }) | AsVector();
@@ -53,4 +56,46 @@ TEST(TransformTest, ZeroElements) {
         | Transform([](int x) { return x * 2; })
         | AsVector();
     ASSERT_TRUE(result.empty());
-}
\ No newline at end of file
+}
+
+TEST(TransformTest, RandomAccess) {
+    std::vector<int> input = {1, 2, 3, 4, 5};
+    auto flow = AsDataFlow(input) | Transform([](int x) { return x * 10; });
+
+    auto begin = flow.begin();
+    auto end = flow.end();
+    ASSERT_EQ(end - begin, 5);
+    ASSERT_EQ(begin[3], 40);
+    ASSERT_EQ(*(begin + 2), 30);
+    ASSERT_TRUE(begin + 5 == end);
+    ASSERT_TRUE(begin < end);
+
+    begin += 4;
+    ASSERT_EQ(*begin, 50);
+    --begin;
+    ASSERT_EQ(*begin, 40);
+    ASSERT_EQ(*std::lower_bound(flow.begin(), flow.end(), 25), 30);
+}
+
+TEST(TransformTest, KeepsBidirectionalCategory) {
+    std::list<int> input = {1, 2, 3};
+    auto flow = AsDataFlow(input) | Transform([](int x) { return x + 1; });
+    using iterator = decltype(flow.begin());
+    ASSERT_TRUE((std::is_same_v<std::iterator_traits<iterator>::iterator_category, std::bidirectional_iterator_tag>));
+    ASSERT_EQ(std::distance(flow.begin(), flow.end()), 3);
+    ASSERT_THAT(flow | AsVector(), testing::ElementsAre(2, 3, 4));
+}
+
+TEST(TransformTest, ModelsRandomAccessIterator) {
+    std::vector<int> input = {3, 1, 2};
+    int offset = 10;
+    auto flow = AsDataFlow(input) | Transform([offset](int x) { return x + offset; });
+    using iterator = decltype(flow.begin());
+    static_assert(std::random_access_iterator<iterator>);
+    static_assert(std::default_initializable<iterator>);
+
+    iterator copy;
+    copy = flow.begin();
+    ASSERT_EQ(std::ranges::distance(copy, flow.end()), 3);
+    ASSERT_EQ(*std::ranges::max_element(copy, flow.end()), 13);
+}